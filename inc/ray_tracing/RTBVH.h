@@ -0,0 +1,166 @@
+#pragma once
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <glm.hpp>
+#include "RayTracingData.h"
+#include "RTFrustum.h"
+
+// 扁平化的 BVH 节点（32 字节，两个节点正好一条缓存行）
+struct RTBVHNode {
+    glm::vec3 boundsMin;
+    int leftFirst;         // 内部节点：左孩子下标（右孩子 = leftFirst + 1）；叶子：primIndices 中的起始位置
+    glm::vec3 boundsMax;
+    int count;             // 叶子中的球体数，0 表示内部节点
+};
+
+// 球体的层次包围盒：SAH 分桶构建，节点连续存放在一个数组里
+class RTBVH {
+public:
+    void Build(const std::vector<RTSphereData>& spheres);
+    void Clear();
+
+    // 拓扑不变（球体数量与顺序相同），只有球心/半径变化时重新计算各节点包围盒
+    void Refit(const std::vector<RTSphereData>& spheres);
+
+    // 每帧调用：能 refit 就 refit；球体数量变化，或 refit 后 SAH 代价超过
+    // 构建时的 rebuildThreshold 倍（树的质量退化）时完全重建。返回是否重建
+    bool Update(const std::vector<RTSphereData>& spheres, float rebuildThreshold);
+
+    // 以根节点面积归一化的 SAH 代价，用于衡量树的质量
+    float ComputeSAHCost() const;
+
+    bool Empty() const { return nodes.empty(); }
+    const std::vector<RTBVHNode>& GetNodes() const { return nodes; }
+    const std::vector<int>& GetPrimIndices() const { return primIndices; }
+
+    // 最近交点遍历：对可能命中的叶子调用 leafFn(first, count, tMax)，[first, first + count) 为
+    // primIndices 中的一段；leafFn 命中更近的交点时应缩短 tMax，之后更远的节点会被剪掉
+    template <typename LeafFn>
+    void ClosestHit(const glm::vec3& origin, const glm::vec3& dir, float& tMax, LeafFn&& leafFn) const;
+
+    // 任意交点遍历（阴影射线）：occludeFn(first, count) 返回 true 时立即结束并返回 true
+    template <typename OccludeFn>
+    bool AnyHit(const glm::vec3& origin, const glm::vec3& dir, float tMax, OccludeFn&& occludeFn) const;
+
+    // 视锥遍历（主光线包）：对与 frustum 相交的叶子调用 leafFn(first, count)
+    template <typename LeafFn>
+    void FrustumQuery(const RTFrustum& frustum, LeafFn&& leafFn) const;
+
+    static const int MaxDepth = 64;     // 遍历栈深度，构建时超过此深度直接生成叶子
+    static const int MaxLeafSize = 8;   // 叶子最多容纳的球体数（SAH 认为不划算时）
+
+private:
+    struct BuildEntry {
+        int nodeIndex;
+        int depth;
+    };
+
+    void UpdateNodeBounds(int nodeIndex);
+    float FindBestSplit(const RTBVHNode& node, int& axis, float& splitPos) const;
+
+    // 射线与包围盒求交：返回进入距离，未命中（或比 tMax 更远）返回 +inf
+    static float IntersectAABB(const RTBVHNode& node, const glm::vec3& origin, const glm::vec3& invDir, float tMax);
+
+    std::vector<RTBVHNode> nodes;
+    std::vector<int> primIndices;        // 叶子引用的球体下标
+    float builtSAHCost = 0.0f;           // 最近一次完全构建时的 SAH 代价
+
+    // 每个球体的包围盒与球心（refit 时原地更新）
+    std::vector<glm::vec3> primMin, primMax, primCentroid;
+};
+
+inline float RTBVH::IntersectAABB(const RTBVHNode& node, const glm::vec3& origin, const glm::vec3& invDir, float tMax) {
+    float tx1 = (node.boundsMin.x - origin.x) * invDir.x, tx2 = (node.boundsMax.x - origin.x) * invDir.x;
+    float tNear = std::min(tx1, tx2), tFar = std::max(tx1, tx2);
+    float ty1 = (node.boundsMin.y - origin.y) * invDir.y, ty2 = (node.boundsMax.y - origin.y) * invDir.y;
+    tNear = std::max(tNear, std::min(ty1, ty2)); tFar = std::min(tFar, std::max(ty1, ty2));
+    float tz1 = (node.boundsMin.z - origin.z) * invDir.z, tz2 = (node.boundsMax.z - origin.z) * invDir.z;
+    tNear = std::max(tNear, std::min(tz1, tz2)); tFar = std::min(tFar, std::max(tz1, tz2));
+    if (tFar >= tNear && tFar > 0.0f && tNear < tMax) return tNear;
+    return std::numeric_limits<float>::infinity();
+}
+
+template <typename LeafFn>
+void RTBVH::ClosestHit(const glm::vec3& origin, const glm::vec3& dir, float& tMax, LeafFn&& leafFn) const {
+    if (nodes.empty()) return;
+    const float inf = std::numeric_limits<float>::infinity();
+    glm::vec3 invDir = 1.0f / dir;
+
+    // 栈中同时记录进入距离，出栈时若已比当前最近交点远则直接跳过
+    int stackNode[MaxDepth];
+    float stackDist[MaxDepth];
+    int stackSize = 0;
+
+    if (IntersectAABB(nodes[0], origin, invDir, tMax) == inf) return;
+    int nodeIndex = 0;
+    while (true) {
+        const RTBVHNode& node = nodes[nodeIndex];
+        if (node.count > 0) {
+            leafFn(node.leftFirst, node.count, tMax);
+        } else {
+            int nearChild = node.leftFirst, farChild = node.leftFirst + 1;
+            float dNear = IntersectAABB(nodes[nearChild], origin, invDir, tMax);
+            float dFar = IntersectAABB(nodes[farChild], origin, invDir, tMax);
+            if (dNear > dFar) { std::swap(nearChild, farChild); std::swap(dNear, dFar); }
+            if (dNear != inf) {
+                if (dFar != inf) {
+                    stackNode[stackSize] = farChild;
+                    stackDist[stackSize++] = dFar;
+                }
+                nodeIndex = nearChild;
+                continue;
+            }
+        }
+        // 出栈
+        nodeIndex = -1;
+        while (stackSize > 0) {
+            --stackSize;
+            if (stackDist[stackSize] < tMax) {
+                nodeIndex = stackNode[stackSize];
+                break;
+            }
+        }
+        if (nodeIndex < 0) return;
+    }
+}
+
+template <typename OccludeFn>
+bool RTBVH::AnyHit(const glm::vec3& origin, const glm::vec3& dir, float tMax, OccludeFn&& occludeFn) const {
+    if (nodes.empty()) return false;
+    const float inf = std::numeric_limits<float>::infinity();
+    glm::vec3 invDir = 1.0f / dir;
+
+    int stack[MaxDepth + 2];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const RTBVHNode& node = nodes[stack[--stackSize]];
+        if (IntersectAABB(node, origin, invDir, tMax) == inf) continue;
+        if (node.count > 0) {
+            if (occludeFn(node.leftFirst, node.count)) return true;
+        } else {
+            stack[stackSize++] = node.leftFirst + 1;
+            stack[stackSize++] = node.leftFirst;
+        }
+    }
+    return false;
+}
+
+template <typename LeafFn>
+void RTBVH::FrustumQuery(const RTFrustum& frustum, LeafFn&& leafFn) const {
+    if (nodes.empty()) return;
+    int stack[MaxDepth + 2];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const RTBVHNode& node = nodes[stack[--stackSize]];
+        if (!frustum.IntersectsAABB(node.boundsMin, node.boundsMax)) continue;
+        if (node.count > 0) {
+            leafFn(node.leftFirst, node.count);
+        } else {
+            stack[stackSize++] = node.leftFirst + 1;
+            stack[stackSize++] = node.leftFirst;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <glm.hpp>
+#include "RTTexture.h"
+#include "RTMipmap.h"
+
+// 立方体贴图的面，顺序与 OpenGL 的 GL_TEXTURE_CUBE_MAP_POSITIVE_X + i 相同（LoadTexture.h 的 loadCubemap）
+enum RTCubeFace {
+    CUBE_FACE_POS_X,
+    CUBE_FACE_NEG_X,
+    CUBE_FACE_POS_Y,
+    CUBE_FACE_NEG_Y,
+    CUBE_FACE_POS_Z,
+    CUBE_FACE_NEG_Z,
+    CUBE_FACE_COUNT
+};
+
+// 方向 -> 面与面内坐标 (s, t) ∈ [0, 1]，不需要归一化，也不调用任何超越函数：选出绝对值最大的分量，再做一次除法
+// 面内朝向按 OpenGL 规范：t = 0 为面的第一行（图像顶部）；分量相等时依次优先 x、y、z，-0 视为正
+// RTSimdKernels::directionToCube 的各指令集版本与本函数逐位一致
+inline int RTDirectionToCube(float x, float y, float z, float& s, float& t) {
+    float ax = std::fabs(x), ay = std::fabs(y), az = std::fabs(z);
+    int face;
+    float ma, sc, tc;
+    if (ax >= ay && ax >= az) {
+        face = x < 0.0f ? CUBE_FACE_NEG_X : CUBE_FACE_POS_X;
+        ma = ax;
+        sc = x < 0.0f ? z : -z;
+        tc = -y;
+    } else if (ay >= az) {
+        face = y < 0.0f ? CUBE_FACE_NEG_Y : CUBE_FACE_POS_Y;
+        ma = ay;
+        sc = x;
+        tc = y < 0.0f ? -z : z;
+    } else {
+        face = z < 0.0f ? CUBE_FACE_NEG_Z : CUBE_FACE_POS_Z;
+        ma = az;
+        sc = z < 0.0f ? -x : x;
+        tc = -y;
+    }
+    float scale = 0.5f / ma;
+    s = sc * scale + 0.5f;
+    t = tc * scale + 0.5f;
+    return face;
+}
+
+// RTDirectionToCube 的逆映射：面内坐标 (s, t) 对应的方向（未归一化）
+inline glm::vec3 RTCubeToDirection(int face, float s, float t) {
+    float sc = 2.0f * s - 1.0f, tc = 2.0f * t - 1.0f;
+    switch (face) {
+    case CUBE_FACE_POS_X: return glm::vec3(1.0f, -tc, -sc);
+    case CUBE_FACE_NEG_X: return glm::vec3(-1.0f, -tc, sc);
+    case CUBE_FACE_POS_Y: return glm::vec3(sc, 1.0f, tc);
+    case CUBE_FACE_NEG_Y: return glm::vec3(sc, -1.0f, -tc);
+    case CUBE_FACE_POS_Z: return glm::vec3(sc, -tc, 1.0f);
+    default:              return glm::vec3(-sc, -tc, -1.0f);
+    }
+}
+
+// 立方体贴图：六个边长为 faceSize 的正方形面，各自一套 mip 金字塔
+// 采样不跨面过滤，双线性在面的边缘截断（粗糙的 mip 级别上接缝处会略有色差）
+struct RTCubemap {
+    int faceSize = 0;
+    RTMipTexture faces[CUBE_FACE_COUNT];
+
+    // 从等距柱状投影的 mip 转换：每个纹素取中心方向，按纹素张角选择 equirect 的 mip 级别三线性采样
+    // faceSize <= 0 时取 equirect 宽度的 1 / 4（赤道处分辨率相同）
+    void BuildFromEquirect(const RTMipTexture& equirect, int faceSize, RTTextureLayout layout = TEXTURE_LAYOUT_LINEAR);
+    // 直接使用六个面（顺序见 RTCubeFace）；各面须为大小相同的正方形，否则返回 false 并保持为空
+    bool BuildFromFaces(const std::vector<RTTexture>& faceImages, RTTextureLayout layout = TEXTURE_LAYOUT_LINEAR);
+    void SetLayout(RTTextureLayout layout);
+    void Clear();
+    bool Empty() const { return faceSize == 0; }
+};
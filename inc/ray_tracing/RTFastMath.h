@@ -0,0 +1,242 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RT_FAST_MATH_SSE 1
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// 着色热点中 libm 函数的多项式近似：球面 UV 的 atan2 / asin，以及开方
+// Phong 高光的固定指数用 RTFastPowInt（连乘）；通用的 RTFastPow / RTFastPowSSE 目前没有渲染路径使用，
+// 只作为 ray_tracing_kernel_bench 中与 libm pow 对比的候选实现
+// 标量版本与 SSE（4 路）/ AVX2（8 路）版本的运算顺序完全相同，同一输入的结果逐位一致；
+// AVX2 版本只在以 AVX2 编译的翻译单元（RTSimdAVX2.cpp）中可见
+// 误差为单精度下实测的最大值，需要参考级精度时用 MATH_PRECISION_ACCURATE 走 libm
+
+enum RTMathPrecision {
+    MATH_PRECISION_ACCURATE, // libm（std::atan2 / std::asin / std::pow）
+    MATH_PRECISION_FAST      // RTFast* 多项式近似
+};
+
+namespace RTFastMathConst {
+    const float HalfPi = 1.57079637f;
+    const float Pi = 3.14159274f;
+    const float InvPi = 0.318309873f;
+    const float InvTwoPi = 0.159154937f;
+
+    // atan(a) ≈ a * P(a²)，a ∈ [0, 1]，误差 ≤ 2e-6 弧度
+    const float Atan0 = 0.99997726f, Atan1 = -0.33262347f, Atan2 = 0.19354346f;
+    const float Atan3 = -0.11643287f, Atan4 = 0.05265332f, Atan5 = -0.01172120f;
+
+    // asin(x) ≈ π/2 - sqrt(1 - x) * P(x)，x ∈ [0, 1]（Abramowitz & Stegun 4.4.45），误差 ≤ 7e-5 弧度
+    const float Asin0 = 1.5707288f, Asin1 = -0.2121144f, Asin2 = 0.0742610f, Asin3 = -0.0187293f;
+
+    // log2(1 + t) ≈ t * P(t)，t ∈ [0, 1)，误差 ≤ 1.5e-6
+    const float Log0 = 1.44269326f, Log1 = -0.721162734f, Log2 = 0.477705927f, Log3 = -0.339247756f;
+    const float Log4 = 0.215588501f, Log5 = -0.0960662218f, Log6 = 0.020490337f;
+
+    // 2^f ≈ 1 + f * P(f)，f ∈ [0, 1)，相对误差 ≤ 3e-7
+    const float Exp0 = 0.693147577f, Exp1 = 0.240206874f, Exp2 = 0.0556586641f;
+    const float Exp3 = 0.00919680217f, Exp4 = 0.00178966498f;
+
+    const float MinNormal = 1.17549435e-38f;
+    const float MinExp2 = -126.0f; // 更小的结果按下限处理（对 [0, 1] 底数的高光项即为 0）
+}
+
+// 非负数开方：直接用硬件开方指令（结果与 std::sqrt 相同，都是正确舍入），省去 errno 检查与负数分支
+// 负数按 0 处理
+inline float RTFastSqrt(float x) {
+#ifdef RT_FAST_MATH_SSE
+    return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(std::max(x, 0.0f))));
+#else
+    return std::sqrt(std::max(x, 0.0f));
+#endif
+}
+
+// 与 std::atan2 相同的象限约定（y 为 ±0 时按符号位取 ±0 / ±π）
+inline float RTFastAtan2(float y, float x) {
+    using namespace RTFastMathConst;
+    float ax = std::fabs(x), ay = std::fabs(y);
+    float mx = std::max(ax, ay), mn = std::min(ax, ay);
+    float a = mx > 0.0f ? mn / mx : 0.0f;
+    float s = a * a;
+    float r = (((((Atan5 * s + Atan4) * s + Atan3) * s + Atan2) * s + Atan1) * s + Atan0) * a;
+    if (ay > ax) r = HalfPi - r;
+    if (x < 0.0f) r = Pi - r;
+    return std::copysign(r, y);
+}
+
+// x 限制在 [-1, 1]
+inline float RTFastAsin(float x) {
+    using namespace RTFastMathConst;
+    float ax = std::min(std::fabs(x), 1.0f);
+    float p = ((Asin3 * ax + Asin2) * ax + Asin1) * ax + Asin0;
+    float r = HalfPi - RTFastSqrt(1.0f - ax) * p;
+    return std::copysign(r, x);
+}
+
+// x^y，要求 y > 0 且结果不超过 2^127；x 小于最小正规数（含 0 与负数）时返回 0
+// log2 的绝对误差按 |y| 放大：y = 32 时相对误差约 4e-5
+// 两个多项式都用 Estrin 形式求值（依赖链比 Horner 短），SIMD 版本按同样的顺序运算
+inline float RTFastPow(float x, float y) {
+    using namespace RTFastMathConst;
+    if (!(x >= MinNormal)) return 0.0f;
+
+    // log2(x) = 指数 + log2(尾数)，尾数 ∈ [1, 2)
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    float e = static_cast<float>(static_cast<int>(bits >> 23) - 127);
+    uint32_t mantissaBits = (bits & 0x007fffffu) | 0x3f800000u;
+    float m;
+    std::memcpy(&m, &mantissaBits, sizeof(m));
+    float t = m - 1.0f;
+    float t2 = t * t;
+    float l = ((Log0 + Log1 * t) + t2 * (Log2 + Log3 * t) + (t2 * t2) * ((Log4 + Log5 * t) + t2 * Log6)) * t + e;
+
+    // 2^z = 2^floor(z) * 2^frac(z)
+    float z = std::min(std::max(y * l, MinExp2), 127.0f);
+    int zi = static_cast<int>(z);
+    if (static_cast<float>(zi) > z) --zi; // 向下取整（截断对负数偏大一）
+    float f = z - static_cast<float>(zi);
+    float f2 = f * f;
+    float p = ((Exp0 + Exp1 * f) + f2 * (Exp2 + Exp3 * f) + (f2 * f2) * Exp4) * f + 1.0f;
+    uint32_t pBits;
+    std::memcpy(&pBits, &p, sizeof(pBits));
+    pBits += static_cast<uint32_t>(zi) << 23;
+    std::memcpy(&p, &pBits, sizeof(p));
+    return p;
+}
+
+// 整数次幂（n >= 0），按二进制展开连乘；n 为编译期常量时完全展开（x^32 为 5 次乘法），
+// 每次乘法只引入一次舍入，比 RTFastPow 更快也更准
+inline float RTFastPowInt(float x, int n) {
+    float result = 1.0f;
+    while (n > 0) {
+        if (n & 1) result *= x;
+        x *= x;
+        n >>= 1;
+    }
+    return result;
+}
+
+// 与 RTDirectionToUV 相同的等距柱状投影
+inline void RTFastDirectionToUV(float x, float y, float z, float& u, float& v) {
+    using namespace RTFastMathConst;
+    u = 0.5f + RTFastAtan2(z, x) * InvTwoPi;
+    v = 0.5f - RTFastAsin(y) * InvPi;
+}
+
+#ifdef RT_FAST_MATH_SSE
+// 4 路版本：a、b 按 mask 选择（mask 为全 1 的通道取 a）
+inline __m128 RTSelectSSE(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline __m128 RTFastSqrtSSE(__m128 x) {
+    return _mm_sqrt_ps(_mm_max_ps(x, _mm_setzero_ps()));
+}
+
+inline __m128 RTFastAtan2SSE(__m128 y, __m128 x) {
+    using namespace RTFastMathConst;
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    __m128 ax = _mm_andnot_ps(signBit, x), ay = _mm_andnot_ps(signBit, y);
+    __m128 mx = _mm_max_ps(ax, ay), mn = _mm_min_ps(ax, ay);
+    __m128 a = _mm_and_ps(_mm_cmpgt_ps(mx, _mm_setzero_ps()), _mm_div_ps(mn, mx));
+    __m128 s = _mm_mul_ps(a, a);
+    __m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(Atan5), s), _mm_set1_ps(Atan4));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(Atan3));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(Atan2));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(Atan1));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(Atan0));
+    r = _mm_mul_ps(r, a);
+    r = RTSelectSSE(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(HalfPi), r), r);
+    r = RTSelectSSE(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(Pi), r), r);
+    return _mm_or_ps(r, _mm_and_ps(signBit, y));
+}
+
+inline __m128 RTFastAsinSSE(__m128 x) {
+    using namespace RTFastMathConst;
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    __m128 ax = _mm_min_ps(_mm_andnot_ps(signBit, x), _mm_set1_ps(1.0f));
+    __m128 p = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(Asin3), ax), _mm_set1_ps(Asin2));
+    p = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(Asin1));
+    p = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(Asin0));
+    __m128 r = _mm_sub_ps(_mm_set1_ps(HalfPi), _mm_mul_ps(RTFastSqrtSSE(_mm_sub_ps(_mm_set1_ps(1.0f), ax)), p));
+    return _mm_or_ps(r, _mm_and_ps(signBit, x));
+}
+
+inline __m128 RTFastPowSSE(__m128 x, __m128 y) {
+    using namespace RTFastMathConst;
+    __m128 valid = _mm_cmpge_ps(x, _mm_set1_ps(MinNormal));
+    __m128i bits = _mm_castps_si128(x);
+    __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+                                             _mm_set1_epi32(0x3f800000)));
+    __m128 t = _mm_sub_ps(m, _mm_set1_ps(1.0f));
+    __m128 t2 = _mm_mul_ps(t, t);
+    __m128 l01 = _mm_add_ps(_mm_set1_ps(Log0), _mm_mul_ps(_mm_set1_ps(Log1), t));
+    __m128 l23 = _mm_add_ps(_mm_set1_ps(Log2), _mm_mul_ps(_mm_set1_ps(Log3), t));
+    __m128 l456 = _mm_add_ps(_mm_add_ps(_mm_set1_ps(Log4), _mm_mul_ps(_mm_set1_ps(Log5), t)),
+                             _mm_mul_ps(t2, _mm_set1_ps(Log6)));
+    __m128 l = _mm_add_ps(_mm_add_ps(l01, _mm_mul_ps(t2, l23)), _mm_mul_ps(_mm_mul_ps(t2, t2), l456));
+    l = _mm_add_ps(_mm_mul_ps(l, t), e);
+
+    __m128 z = _mm_min_ps(_mm_max_ps(_mm_mul_ps(y, l), _mm_set1_ps(MinExp2)), _mm_set1_ps(127.0f));
+    __m128i zi = _mm_cvttps_epi32(z);
+    __m128 ziF = _mm_cvtepi32_ps(zi);
+    __m128 adjust = _mm_cmpgt_ps(ziF, z);
+    zi = _mm_add_epi32(zi, _mm_castps_si128(adjust)); // 全 1 即 -1
+    ziF = _mm_cvtepi32_ps(zi);
+    __m128 f = _mm_sub_ps(z, ziF);
+    __m128 f2 = _mm_mul_ps(f, f);
+    __m128 p01 = _mm_add_ps(_mm_set1_ps(Exp0), _mm_mul_ps(_mm_set1_ps(Exp1), f));
+    __m128 p23 = _mm_add_ps(_mm_set1_ps(Exp2), _mm_mul_ps(_mm_set1_ps(Exp3), f));
+    __m128 p = _mm_add_ps(_mm_add_ps(p01, _mm_mul_ps(f2, p23)), _mm_mul_ps(_mm_mul_ps(f2, f2), _mm_set1_ps(Exp4)));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f));
+    p = _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(p), _mm_slli_epi32(zi, 23)));
+    return _mm_and_ps(valid, p);
+}
+#endif
+
+#if defined(__AVX2__)
+// 8 路版本，与上面的 SSE 版本一一对应
+inline __m256 RTFastSqrtAVX2(__m256 x) {
+    return _mm256_sqrt_ps(_mm256_max_ps(x, _mm256_setzero_ps()));
+}
+
+inline __m256 RTFastAtan2AVX2(__m256 y, __m256 x) {
+    using namespace RTFastMathConst;
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    __m256 ax = _mm256_andnot_ps(signBit, x), ay = _mm256_andnot_ps(signBit, y);
+    __m256 mx = _mm256_max_ps(ax, ay), mn = _mm256_min_ps(ax, ay);
+    __m256 a = _mm256_and_ps(_mm256_cmp_ps(mx, _mm256_setzero_ps(), _CMP_GT_OQ), _mm256_div_ps(mn, mx));
+    __m256 s = _mm256_mul_ps(a, a);
+    __m256 r = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(Atan5), s), _mm256_set1_ps(Atan4));
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(Atan3));
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(Atan2));
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(Atan1));
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(Atan0));
+    r = _mm256_mul_ps(r, a);
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(HalfPi), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(Pi), r), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+    return _mm256_or_ps(r, _mm256_and_ps(signBit, y));
+}
+
+inline __m256 RTFastAsinAVX2(__m256 x) {
+    using namespace RTFastMathConst;
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    __m256 ax = _mm256_min_ps(_mm256_andnot_ps(signBit, x), _mm256_set1_ps(1.0f));
+    __m256 p = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(Asin3), ax), _mm256_set1_ps(Asin2));
+    p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(Asin1));
+    p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(Asin0));
+    __m256 r = _mm256_sub_ps(_mm256_set1_ps(HalfPi),
+                             _mm256_mul_ps(RTFastSqrtAVX2(_mm256_sub_ps(_mm256_set1_ps(1.0f), ax)), p));
+    return _mm256_or_ps(r, _mm256_and_ps(signBit, x));
+}
+#endif
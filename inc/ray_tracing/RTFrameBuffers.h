@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// RayTracer 的帧输出缓冲：追踪结果（RGB，每像素 3 字节，第一行为图像顶部）直接写入其中一个缓冲，
+// 完成后通过 Present 交给显示端。缓冲轮流使用：追踪中 / 待显示 / 显示端使用中
+// 除 GetData 返回的内存外，所有函数只在调用 RayTracer::Render / SubmitFrame / TryGetLatestFrame / Resize
+// 的线程上调用（显示端可以在其中使用 OpenGL）
+class RTFrameBuffers {
+public:
+    static const int SlotCount = 3;
+
+    virtual ~RTFrameBuffers() {}
+
+    // 按输出分辨率重新分配全部缓冲，每个至少 width * height * 3 字节
+    virtual void Resize(int width, int height) = 0;
+    virtual unsigned char* GetData(int slot) = 0;
+
+    // 显示端是否已经用完该缓冲（不阻塞）
+    virtual bool IsSlotIdle(int /*slot*/) { return true; }
+    // 阻塞直到显示端用完该缓冲
+    virtual void WaitSlotIdle(int /*slot*/) {}
+    // 缓冲中左上角 w x h 的图像已经完成
+    virtual void Present(int /*slot*/, int /*w*/, int /*h*/) {}
+};
+
+// 默认实现：普通内存，不显示（离线渲染、测试与基准程序）
+class RTMemoryFrameBuffers : public RTFrameBuffers {
+public:
+    void Resize(int width, int height) override {
+        for (int i = 0; i < SlotCount; ++i) buffers[i].assign(static_cast<size_t>(width) * height * 3, 0);
+    }
+    unsigned char* GetData(int slot) override { return buffers[slot].data(); }
+
+private:
+    std::vector<unsigned char> buffers[SlotCount];
+};
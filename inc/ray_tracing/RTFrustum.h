@@ -0,0 +1,44 @@
+#pragma once
+#include <cmath>
+#include <glm.hpp>
+
+// 顶点在 apex 的四棱锥，包住一个主光线包的全部光线；四个侧面的法线朝内
+// 剔除时留有与距离成比例的余量，浮点误差不会把实际可能命中的球体剔除
+struct RTFrustum {
+    glm::vec3 apex;
+    glm::vec3 normals[4];
+
+    static constexpr float Margin = 1e-4f;
+
+    // edges 为按顺序（顺时针或逆时针均可）排列的四条棱的方向
+    void Build(const glm::vec3& origin, const glm::vec3 edges[4]) {
+        apex = origin;
+        glm::vec3 axis = edges[0] + edges[1] + edges[2] + edges[3];
+        for (int i = 0; i < 4; ++i) {
+            glm::vec3 n = glm::normalize(glm::cross(edges[i], edges[(i + 1) % 4]));
+            normals[i] = glm::dot(n, axis) < 0.0f ? -n : n;
+        }
+    }
+
+    bool IntersectsSphere(const glm::vec3& center, float radius) const {
+        glm::vec3 d = center - apex;
+        float slack = radius + Margin * (std::fabs(d.x) + std::fabs(d.y) + std::fabs(d.z));
+        for (int i = 0; i < 4; ++i) {
+            if (glm::dot(normals[i], d) < -slack) return false;
+        }
+        return true;
+    }
+
+    // 包围盒在某个侧面外侧（离该面最近的顶点也在外侧）时剔除
+    bool IntersectsAABB(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+        for (int i = 0; i < 4; ++i) {
+            const glm::vec3& n = normals[i];
+            glm::vec3 p(n.x >= 0.0f ? boundsMax.x : boundsMin.x,
+                        n.y >= 0.0f ? boundsMax.y : boundsMin.y,
+                        n.z >= 0.0f ? boundsMax.z : boundsMin.z);
+            glm::vec3 d = p - apex;
+            if (glm::dot(n, d) < -Margin * (std::fabs(d.x) + std::fabs(d.y) + std::fabs(d.z))) return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <glm.hpp>
+
+// 离线渲染的图像输出，不依赖 OpenGL 与第三方库
+// 像素按行存储，第一行为图像顶部（与 RayTracer::GetPixels 一致）
+
+// 8 位 RGB，二进制 PPM (P6)
+bool RTWritePPM(const std::string& path, int width, int height, const unsigned char* rgb);
+
+// 8 位 RGB，PNG（deflate 只使用不压缩的存储块，体积约等于原始数据）
+bool RTWritePNG(const std::string& path, int width, int height, const unsigned char* rgb);
+
+// 32 位浮点 RGB，PFM（保留超过 1 的 HDR 颜色）
+bool RTWritePFM(const std::string& path, int width, int height, const std::vector<glm::vec3>& rgb);
+
+// 按扩展名（.ppm / .png / .pfm，不区分大小写）选择格式；.pfm 需要 hdr，否则由 rgb 转换
+bool RTWriteImage(const std::string& path, int width, int height,
+                  const unsigned char* rgb, const std::vector<glm::vec3>* hdr = nullptr);
@@ -0,0 +1,232 @@
+#pragma once
+#include <cmath>
+#include <algorithm>
+#include <glm.hpp>
+#include "RayTracingData.h"
+#include "RTTexture.h"
+#include "RTMipmap.h"
+#include "RTCubemap.h"
+#include "RTFastMath.h"
+
+// RayTracer::Trace 中的热点运算，以内联函数提供，便于单独做微基准与替换实现
+// 修改运算顺序会改变输出（RTSimd 中的求交内核与 RTIntersectSphere 逐位一致）
+
+// 射线与球体求交，t 为最近的正向交点（> 0.001）
+inline bool RTIntersectSphere(const glm::vec3& origin, const glm::vec3& dir, const RTSphereData& sphere, float& t) {
+    glm::vec3 oc = origin - sphere.center;
+    float a = glm::dot(dir, dir);
+    float b = 2.0f * glm::dot(oc, dir);
+    float c = glm::dot(oc, oc) - sphere.radius * sphere.radius;
+    float discriminant = b * b - 4 * a * c;
+
+    if (discriminant < 0) {
+        return false;
+    } else {
+        // 单精度开方，与 RTSimd 中各指令集的内核结果逐位一致
+        float t1 = (-b - std::sqrt(discriminant)) / (2.0f * a);
+        if (t1 > 0.001f) {
+            t = t1;
+            return true;
+        }
+        float t2 = (-b + std::sqrt(discriminant)) / (2.0f * a);
+        if (t2 > 0.001f) {
+            t = t2;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 方向（单位向量）到等距柱状投影 UV，球面纹理与环境贴图共用
+// u = 0.5 + atan2(z, x) / (2*pi)
+// v = 0.5 - asin(y) / pi
+inline void RTDirectionToUV(const glm::vec3& dir, float& u, float& v,
+                            RTMathPrecision precision = MATH_PRECISION_ACCURATE) {
+    if (precision == MATH_PRECISION_FAST) {
+        RTFastDirectionToUV(dir.x, dir.y, dir.z, u, v);
+        return;
+    }
+    const float invTwoPi = 1.0f / (2.0f * M_PI);
+    const float invPi = 1.0f / M_PI;
+    u = 0.5f + atan2(dir.z, dir.x) * invTwoPi;
+    v = 0.5f - asin(dir.y) * invPi;
+}
+
+// 最近点采样，重复寻址
+inline glm::vec3 RTSampleTexture(const RTTexture& tex, float u, float v) {
+    if (tex.data.empty()) return glm::vec3(1.0f, 0.0f, 1.0f); // 错误紫
+
+    // 简单的重复模式 (Repeat)
+    u = u - floor(u);
+    v = v - floor(v);
+
+    int x = static_cast<int>(u * tex.width);
+    int y = static_cast<int>(v * tex.height);
+
+    // 边界检查
+    x = std::max(0, std::min(x, tex.width - 1));
+    y = std::max(0, std::min(y, tex.height - 1));
+
+    int index = (y * tex.width + x) * tex.channels;
+
+    float r = tex.data[index] / 255.0f;
+    float g = r;
+    float b = r;
+    if (tex.channels > 1) {
+        g = tex.data[index + 1] / 255.0f;
+    }
+    if (tex.channels > 2) {
+        b = tex.data[index + 2] / 255.0f;
+    }
+
+    return glm::vec3(r, g, b);
+}
+
+// 等距柱状投影的环境贴图
+inline glm::vec3 RTSampleEnvironment(const RTTexture& env, float intensity, const glm::vec3& dir,
+                                     RTMathPrecision precision = MATH_PRECISION_ACCURATE) {
+    float u, v;
+    RTDirectionToUV(dir, u, v, precision);
+    return RTSampleTexture(env, u, v) * intensity;
+}
+
+// 打包的 RGBA8 纹素 -> [0, 1] 颜色
+inline glm::vec3 RTUnpackTexel(uint32_t texel) {
+    const float inv255 = 1.0f / 255.0f;
+    return glm::vec3(static_cast<float>(texel & 0xff), static_cast<float>((texel >> 8) & 0xff),
+                     static_cast<float>((texel >> 16) & 0xff)) * inv255;
+}
+
+// mip 某一级的双线性采样：u 方向重复，v 方向截断（等距柱状投影的两极互不相接）
+inline glm::vec3 RTSampleBilinear(const RTMipLevel& level, float u, float v) {
+    float x = (u - floor(u)) * level.width - 0.5f;
+    float y = std::min(std::max(v, 0.0f), 1.0f) * level.height - 0.5f;
+    float fx = floor(x), fy = floor(y);
+    float tx = x - fx, ty = y - fy;
+
+    int x0 = static_cast<int>(fx), y0 = static_cast<int>(fy);
+    int x1 = x0 + 1, y1 = y0 + 1;
+    if (x0 < 0) x0 += level.width;
+    if (x1 >= level.width) x1 -= level.width;
+    y0 = std::max(y0, 0);
+    y1 = std::min(y1, level.height - 1);
+
+    uint32_t t00, t10, t01, t11;
+    if (level.layout == TEXTURE_LAYOUT_TILED) {
+        // 四个纹素通常落在同一块（常常是同一条缓存行）内
+        size_t c0 = RTMipLevel::TiledColumn(x0), c1 = RTMipLevel::TiledColumn(x1);
+        size_t r0 = level.TiledRow(y0), r1 = level.TiledRow(y1);
+        t00 = level.texels[r0 + c0];
+        t10 = level.texels[r0 + c1];
+        t01 = level.texels[r1 + c0];
+        t11 = level.texels[r1 + c1];
+    } else {
+        const uint32_t* row0 = &level.texels[static_cast<size_t>(y0) * level.width];
+        const uint32_t* row1 = &level.texels[static_cast<size_t>(y1) * level.width];
+        t00 = row0[x0];
+        t10 = row0[x1];
+        t01 = row1[x0];
+        t11 = row1[x1];
+    }
+    glm::vec3 top = glm::mix(RTUnpackTexel(t00), RTUnpackTexel(t10), tx);
+    glm::vec3 bottom = glm::mix(RTUnpackTexel(t01), RTUnpackTexel(t11), tx);
+    return glm::mix(top, bottom, ty);
+}
+
+// 三线性采样：在 floor(lod) 与下一级之间插值，lod 超出范围时截断到首末级
+inline glm::vec3 RTSampleMip(const RTMipTexture& tex, float u, float v, float lod) {
+    if (tex.Empty()) return glm::vec3(1.0f, 0.0f, 1.0f); // 错误紫
+    int last = tex.LevelCount() - 1;
+    if (!(lod > 0.0f)) return RTSampleBilinear(tex.levels[0], u, v);
+    if (lod >= static_cast<float>(last)) return RTSampleBilinear(tex.levels[last], u, v);
+    int level = static_cast<int>(lod);
+    float f = lod - static_cast<float>(level);
+    return glm::mix(RTSampleBilinear(tex.levels[level], u, v), RTSampleBilinear(tex.levels[level + 1], u, v), f);
+}
+
+// 立方体贴图某一面的某一级：双线性采样，在面的边缘截断（不跨面过滤）
+inline glm::vec3 RTSampleCubeLevel(const RTMipLevel& level, float s, float t) {
+    // 截断到首末纹素中心，RTSampleBilinear 的 u 方向重复寻址不会取到对边的纹素
+    float ms = 0.5f / level.width, mt = 0.5f / level.height;
+    s = std::min(std::max(s, ms), 1.0f - ms);
+    t = std::min(std::max(t, mt), 1.0f - mt);
+    return RTSampleBilinear(level, s, t);
+}
+
+// 立方体贴图的最近点采样（第 0 级）
+inline glm::vec3 RTSampleCubeNearest(const RTCubemap& cube, int face, float s, float t) {
+    if (cube.Empty()) return glm::vec3(1.0f, 0.0f, 1.0f); // 错误紫
+    const RTMipLevel& level = cube.faces[face].levels[0];
+    int x = std::min(std::max(static_cast<int>(s * level.width), 0), level.width - 1);
+    int y = std::min(std::max(static_cast<int>(t * level.height), 0), level.height - 1);
+    return RTUnpackTexel(level.Texel(x, y));
+}
+
+// 立方体贴图的三线性采样，lod 的处理同 RTSampleMip
+inline glm::vec3 RTSampleCube(const RTCubemap& cube, int face, float s, float t, float lod) {
+    if (cube.Empty()) return glm::vec3(1.0f, 0.0f, 1.0f); // 错误紫
+    const RTMipTexture& tex = cube.faces[face];
+    int last = tex.LevelCount() - 1;
+    if (!(lod > 0.0f)) return RTSampleCubeLevel(tex.levels[0], s, t);
+    if (lod >= static_cast<float>(last)) return RTSampleCubeLevel(tex.levels[last], s, t);
+    int level = static_cast<int>(lod);
+    float f = lod - static_cast<float>(level);
+    return glm::mix(RTSampleCubeLevel(tex.levels[level], s, t), RTSampleCubeLevel(tex.levels[level + 1], s, t), f);
+}
+
+// 光锥（简化的射线微分）：width 为光线起点处的足迹宽度，spread 为展开角（弧度）
+// 主光线从相机出发时 width = 0、spread = 一个像素的张角，沿光线传播 t 后足迹宽度为 width + spread * t
+struct RTRayCone {
+    float width;
+    float spread;
+};
+
+// 光锥在距离 t 处击中半径为 radius 的球面，足迹在球面上张开的角度（弧度），掠射时按 1 / cos 拉长（限制在 10 倍内）
+inline float RTSphereFootprintAngle(const RTRayCone& cone, float t, float radius,
+                                    const glm::vec3& dir, const glm::vec3& normal) {
+    float width = cone.width + cone.spread * t;
+    float cosTheta = std::max(std::fabs(glm::dot(dir, normal)), 0.1f);
+    return width / (radius * cosTheta);
+}
+
+// 在球面上反弹后的光锥：镜面（凸面镜）使展开角增大 2 * width / radius，折射近似保持不变
+inline RTRayCone RTBounceCone(const RTRayCone& cone, float t, float radius, int materialType) {
+    RTRayCone next;
+    next.width = cone.width + cone.spread * t;
+    next.spread = cone.spread;
+    if (materialType == MaterialType::SPECULAR) next.spread += 2.0f * next.width / radius;
+    return next;
+}
+
+// 等距柱状投影纹理上，角宽度 angle（弧度）的足迹对应的 mip 级别：v 方向 pi 弧度对应第 0 级的 height 个纹素
+inline float RTMipLevelForAngle(const RTMipTexture& tex, float angle) {
+    if (tex.Empty()) return 0.0f;
+    float texels = angle * tex.levels[0].height * static_cast<float>(1.0 / M_PI);
+    return texels > 1.0f ? std::log2(texels) : 0.0f;
+}
+
+// 立方体贴图上角宽度 angle 的足迹对应的 mip 级别：一个面的 pi / 2 弧度对应第 0 级的 faceSize 个纹素
+inline float RTMipLevelForCubeAngle(const RTCubemap& cube, float angle) {
+    if (cube.Empty()) return 0.0f;
+    float texels = angle * cube.faceSize * static_cast<float>(2.0 / M_PI);
+    return texels > 1.0f ? std::log2(texels) : 0.0f;
+}
+
+// 单个光源的 Phong 漫反射 + 镜面反射（不含环境光与阴影）
+inline glm::vec3 RTShadePhong(const glm::vec3& normal, const glm::vec3& viewDir, const glm::vec3& lightDir,
+                              const glm::vec3& albedo, const glm::vec3& lightEmission,
+                              RTMathPrecision precision = MATH_PRECISION_ACCURATE) {
+    // 漫反射 (Diffuse)
+    float diff = std::max(glm::dot(normal, lightDir), 0.0f);
+    glm::vec3 diffuse = diff * albedo * lightEmission * 0.5f;
+
+    // 镜面反射 (Specular) - Phong
+    float specularStrength = 0.5f;
+    float shininess = 32.0f;
+    glm::vec3 reflectDir = glm::reflect(-lightDir, normal);
+    float cosAlpha = std::max(glm::dot(viewDir, reflectDir), 0.0f);
+    float spec = precision == MATH_PRECISION_FAST ? RTFastPowInt(cosAlpha, 32) : pow(cosAlpha, shininess);
+    glm::vec3 specular = specularStrength * spec * glm::vec3(1.0f);
+
+    return diffuse + specular;
+}
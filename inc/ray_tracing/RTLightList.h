@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include <glm.hpp>
+#include "RayTracingData.h"
+
+// 发光球体（光源）
+struct RTLight {
+    int sphereIndex;       // 在场景 spheres 中的下标
+    glm::vec3 center;      // 包围球（即球体本身）
+    float radius;
+    glm::vec3 emission;
+    float power;           // 用于按功率采样：亮度 * 半径²
+};
+
+// 场景中所有发光球体的紧凑列表，按 sphereIndex 升序排列
+// 着色时只遍历这个列表，而不是扫描全部球体
+class RTLightList {
+public:
+    // 自发光强度超过该阈值的材质视为光源
+    static bool IsEmissive(const RTMaterial& material) { return glm::length(material.emission) > 0.1f; }
+
+    void Build(const std::vector<RTSphereData>& spheres, const std::vector<RTMaterial>& materials);
+
+    // 拓扑与材质不变，只有 dirtySpheres 的球心/半径/材质下标变化时增量更新；
+    // 若有球体因此变成或不再是光源，退化为完全重建
+    void Update(const std::vector<RTSphereData>& spheres, const std::vector<RTMaterial>& materials,
+                const std::vector<int>& dirtySpheres);
+
+    const std::vector<RTLight>& GetLights() const { return lights; }
+    int Size() const { return static_cast<int>(lights.size()); }
+    bool Empty() const { return lights.empty(); }
+    float GetTotalPower() const { return totalPower; }
+
+    // 按功率采样一个光源：u ∈ [0, 1)，返回光源下标并给出选中概率 pdf
+    int Sample(float u, float& pdf) const;
+
+private:
+    void RebuildDistribution();
+
+    std::vector<RTLight> lights;
+    std::vector<int> sphereToLight;   // 球体下标 -> 光源下标，-1 表示不是光源
+    std::vector<float> cdf;           // 功率的累积分布（归一化，最后一项为 1）
+    float totalPower = 0.0f;
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "RTTexture.h"
+
+// mip 各级纹素的存储顺序
+enum RTTextureLayout {
+    TEXTURE_LAYOUT_LINEAR, // 行优先
+    TEXTURE_LAYOUT_TILED   // 8x8 纹素一块（256 字节）按块行优先，块内 Morton 顺序：每个 4x4 子块连续 64 字节
+};
+
+// mip 金字塔的一级：每个纹素打包为一个 RGBA8（R 在最低字节），采样时不再逐通道做除法，
+// 一次 4 字节读取即可取到完整颜色
+struct RTMipLevel {
+    static const int TileSize = 8;
+
+    int width = 0;
+    int height = 0;
+    int tilesX = 0;                // TEXTURE_LAYOUT_TILED 时每行的块数（宽度向上取整到 8 的倍数）
+    RTTextureLayout layout = TEXTURE_LAYOUT_LINEAR;
+    std::vector<uint32_t> texels;  // 第一行为图像顶部；TILED 时末尾不足一块的部分留空
+
+    // TILED 下标 = TiledColumn(x) + TiledRow(y)：块内 Morton 下标是 x、y 的位交错，
+    // 两部分的位互不重叠，可以分别按列、按行预先算好再相加
+    static size_t TiledColumn(int x) {
+        static const unsigned char spread[8] = {0, 1, 4, 5, 16, 17, 20, 21};
+        return static_cast<size_t>(x >> 3) * (TileSize * TileSize) + spread[x & 7];
+    }
+    size_t TiledRow(int y) const {
+        static const unsigned char spread[8] = {0, 2, 8, 10, 32, 34, 40, 42};
+        return static_cast<size_t>(y >> 3) * tilesX * (TileSize * TileSize) + spread[y & 7];
+    }
+
+    size_t TexelIndex(int x, int y) const {
+        if (layout == TEXTURE_LAYOUT_LINEAR) return static_cast<size_t>(y) * width + x;
+        return TiledColumn(x) + TiledRow(y);
+    }
+    uint32_t Texel(int x, int y) const { return texels[TexelIndex(x, y)]; }
+
+    // 原地转换存储顺序
+    void SetLayout(RTTextureLayout newLayout);
+};
+
+// 注册纹理时生成：第 0 级为原图，之后每级宽高减半（奇数向上取整，2x2 盒式滤波），直到 1x1
+struct RTMipTexture {
+    std::vector<RTMipLevel> levels;
+
+    void Build(const RTTexture& tex, RTTextureLayout layout = TEXTURE_LAYOUT_LINEAR);
+    void SetLayout(RTTextureLayout layout);
+    void Clear() { levels.clear(); }
+    bool Empty() const { return levels.empty(); }
+    int LevelCount() const { return static_cast<int>(levels.size()); }
+};
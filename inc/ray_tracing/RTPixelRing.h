@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// 追踪结果的输出缓冲环（RGB，每个缓冲可容纳 capacity 字节）
+// 支持 glBufferStorage（GL 4.4 / ARB_buffer_storage）时使用持久、一致映射的 PBO：
+// 追踪线程直接写入映射内存，纹理从 PBO 异步更新，围栏保证 GPU 读完之前不会被再次写入；
+// 不支持时退化为普通内存 + glTexSubImage2D
+// 除 GetData 返回的内存外，所有函数只能在 OpenGL 上下文所在的线程调用
+class RTPixelRing {
+public:
+    static const int SlotCount = 3;
+
+    RTPixelRing();
+    ~RTPixelRing();
+
+    // 重新分配全部缓冲（会先等待 GPU 用完旧缓冲）；usePBO 为 false 时不调用任何 OpenGL 函数
+    void Init(size_t capacity, bool usePBO);
+    void Release();
+
+    bool IsPersistent() const { return persistent; }
+    size_t GetCapacity() const { return capacity; }
+    unsigned char* GetData(int slot) const { return data[slot]; }
+
+    // GPU 是否已经读完该缓冲（不阻塞）
+    bool IsSlotIdle(int slot);
+    // 阻塞直到 GPU 读完该缓冲
+    void WaitSlotIdle(int slot);
+
+    // 把 slot 中 w x h 的 RGB 数据更新到纹理左下角；PBO 模式下只提交命令并插入围栏，不等待
+    void Upload(int slot, unsigned int texture, int w, int h);
+
+private:
+    bool LoadBufferStorage();
+
+    size_t capacity = 0;
+    bool persistent = false;
+    unsigned char* data[SlotCount];
+    unsigned int pbo[SlotCount];
+    void* fence[SlotCount];                       // GLsync
+    std::vector<unsigned char> fallback[SlotCount]; // 非 PBO 模式的内存
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include "RTFrameBuffers.h"
+#include "RTPixelRing.h"
+
+// RayTracer 结果的 OpenGL 显示端：持有纹理、全屏四边形与着色器
+// 作为 RayTracer 的帧输出缓冲（RayTracer::SetFrameBuffers），追踪结果直接写入持久映射的 PBO，
+// 完成的帧从 PBO 更新到纹理，Draw 把它放大绘制到整个窗口
+// 需要在 OpenGL 上下文所在的线程创建与使用，且生命周期长于使用它的 RayTracer
+class RTPresenter : public RTFrameBuffers {
+public:
+    RTPresenter(int width, int height);
+    ~RTPresenter();
+
+    // 由 RayTracer::Resize / SetFrameBuffers 调用
+    void Resize(int width, int height) override;
+    unsigned char* GetData(int slot) override { return pixelRing.GetData(slot); }
+    bool IsSlotIdle(int slot) override { return pixelRing.IsSlotIdle(slot); }
+    void WaitSlotIdle(int slot) override { pixelRing.WaitSlotIdle(slot); }
+    void Present(int slot, int w, int h) override;
+
+    // 将最近一次 Present 的帧绘制到屏幕上
+    void Draw();
+
+    bool IsPersistent() const { return pixelRing.IsPersistent(); }
+
+private:
+    void InitGLResources();
+    void SetupScreenShader();
+
+    int width, height;               // 纹理（窗口）分辨率
+    int displayWidth, displayHeight; // 纹理中当前帧的分辨率（位于左下角）
+    unsigned int textureID = 0;
+    unsigned int quadVAO = 0, quadVBO = 0;
+    unsigned int screenShaderProgram = 0;
+    int uvScaleLocation = -1, uvMaxLocation = -1;
+    RTPixelRing pixelRing; // 追踪结果直接写入其中的缓冲（持久映射的 PBO 或普通内存）
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+
+// 轻量的 PCG 随机数生成器，每个像素独立一份，不需要线程同步
+struct RTRandom {
+    uint32_t state;
+
+    explicit RTRandom(uint32_t seed) : state(Hash(seed)) {}
+
+    // 整数哈希（PCG 输出函数），用于由像素坐标 / 帧号生成种子
+    static uint32_t Hash(uint32_t x) {
+        uint32_t s = x * 747796405u + 2891336453u;
+        uint32_t word = ((s >> ((s >> 28u) + 4u)) ^ s) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    uint32_t NextUInt() {
+        state = state * 747796405u + 2891336453u;
+        uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    // [0, 1) 均匀分布
+    float NextFloat() {
+        return (NextUInt() >> 8) * (1.0f / 16777216.0f);
+    }
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include <glm.hpp>
+#include "RayTracingData.h"
+
+// 注册到 RayTracer 纹理库中的纹理句柄，-1 表示无纹理
+typedef int RTTextureHandle;
+const RTTextureHandle RT_INVALID_TEXTURE = -1;
+
+typedef int RTSphereHandle;   // 球体句柄，删除其他球体后仍然有效
+typedef int RTMaterialHandle; // 材质句柄，即材质在 GetMaterials() 中的下标
+
+// 持久化的光追场景：球体、材质与纹理句柄跨帧保存，只有修改过的对象会被标记为脏，
+// RayTracer 据此增量更新加速结构等派生数据
+class RTScene {
+public:
+    enum DirtyFlags {
+        DIRTY_NONE      = 0,
+        DIRTY_SPHERES   = 1 << 0, // 有球体的球心/半径/材质被修改（见 GetDirtySpheres）
+        DIRTY_MATERIALS = 1 << 1, // 有材质或材质的纹理被修改
+        DIRTY_TOPOLOGY  = 1 << 2  // 球体被添加或删除，GetSpheres() 中的顺序发生变化
+    };
+
+    RTMaterialHandle AddMaterial(const RTMaterial& material, RTTextureHandle texture = RT_INVALID_TEXTURE);
+    void UpdateMaterial(RTMaterialHandle handle, const RTMaterial& material);
+    void UpdateMaterialTexture(RTMaterialHandle handle, RTTextureHandle texture);
+
+    RTSphereHandle AddSphere(const glm::vec3& center, float radius, RTMaterialHandle material);
+    // 球心与半径都没有变化时不会标记为脏
+    void UpdateSphere(RTSphereHandle handle, const glm::vec3& center, float radius);
+    void SetSphereMaterial(RTSphereHandle handle, RTMaterialHandle material);
+    void RemoveSphere(RTSphereHandle handle);
+    bool IsValid(RTSphereHandle handle) const;
+
+    // 用整组数组同步场景（兼容直接传 vector 的 Render 接口）：数量不变时逐项比较，只标记变化的部分
+    void Assign(const std::vector<RTSphereData>& spheres,
+                const std::vector<RTMaterial>& materials,
+                const std::vector<RTTextureHandle>& materialTextures);
+    void Clear();
+
+    // 渲染用的紧凑数组，spheres[i].materialIndex 指向 materials
+    const std::vector<RTSphereData>& GetSpheres() const { return spheres; }
+    const std::vector<RTMaterial>& GetMaterials() const { return materials; }
+    const std::vector<RTTextureHandle>& GetMaterialTextures() const { return materialTextures; }
+    int GetSphereIndex(RTSphereHandle handle) const { return IsValid(handle) ? handleToIndex[handle] : -1; }
+
+    unsigned GetDirtyFlags() const { return dirtyFlags; }
+    const std::vector<int>& GetDirtySpheres() const { return dirtySpheres; } // 被修改的球体下标（DIRTY_TOPOLOGY 时无意义）
+    void ClearDirty();
+
+private:
+    void MarkSphereDirty(int index);
+    void SetSphereAt(int index, const glm::vec3& center, float radius, RTMaterialHandle material);
+
+    std::vector<RTSphereData> spheres;
+    std::vector<RTMaterial> materials;
+    std::vector<RTTextureHandle> materialTextures;
+
+    std::vector<int> handleToIndex;   // 句柄 -> spheres 下标，-1 表示已删除
+    std::vector<int> indexToHandle;   // spheres 下标 -> 句柄
+    std::vector<int> freeHandles;
+
+    unsigned dirtyFlags = DIRTY_NONE;
+    std::vector<unsigned char> sphereDirty; // 每个球体的脏标记，避免 dirtySpheres 重复
+    std::vector<int> dirtySpheres;
+};
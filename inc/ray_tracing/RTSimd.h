@@ -0,0 +1,90 @@
+#pragma once
+#include <vector>
+#include <glm.hpp>
+#include "RayTracingData.h"
+
+// 求交内核使用的指令集
+enum RTSimdLevel {
+    SIMD_AUTO,    // 运行时检测 CPU 支持的最高指令集
+    SIMD_SCALAR,  // 标量回退
+    SIMD_SSE,     // 4 路
+    SIMD_AVX2     // 8 路
+};
+
+// 球体场景的 SoA 镜像（去掉了 RTSphereData 的对齐填充）
+// 按 BVH 的 primIndices 顺序排列，因此每个叶子内的球体在各数组中是连续的一段
+struct RTSphereSoA {
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> radius2;      // 半径平方
+    std::vector<int> materialIndex;
+    std::vector<int> sphereIndex;    // 对应的原始 spheres 下标
+    std::vector<int> position;       // 原始 spheres 下标 -> 在 SoA 中的位置
+    int count = 0;
+
+    static const int Padding = 8;    // 末尾填充，保证 8 路读取不越界
+
+    // order[i] 为第 i 个位置对应的原始球体下标
+    void Build(const std::vector<RTSphereData>& spheres, const std::vector<int>& order);
+    // 顺序不变，只刷新 dirtySpheres（原始下标）对应的数据
+    void Update(const std::vector<RTSphereData>& spheres, const std::vector<int>& dirtySpheres);
+};
+
+// 一条射线与 soa[first, first + count) 求最近交点：找到更近（距离相同则原始下标更小）的球体时
+// 更新 tMax 与 hitSphere（原始 spheres 下标）
+typedef void (*RTClosestHitKernel)(const RTSphereSoA& soa, int first, int count,
+                                   const glm::vec3& origin, const glm::vec3& dir,
+                                   float& tMax, int& hitSphere);
+
+// 阴影查询：soa[first, first + count) 中除 skipA / skipB（原始下标）外，是否有球体在 tMax 之前被击中
+typedef bool (*RTAnyHitKernel)(const RTSphereSoA& soa, int first, int count,
+                               const glm::vec3& origin, const glm::vec3& dir,
+                               float tMax, int skipA, int skipB);
+
+// 共享起点的一组光线（主光线包），方向按 SoA 存放以便 SIMD 一次处理多条光线
+// tMax / hitSphere 为每条光线当前的最近交点，由调用方初始化
+struct RTRayPacket {
+    static const int MaxRays = 64;   // 8x8 像素
+    glm::vec3 origin;
+    int count = 0;
+    alignas(32) float dirX[MaxRays];
+    alignas(32) float dirY[MaxRays];
+    alignas(32) float dirZ[MaxRays];
+    alignas(32) float dirDot[MaxRays]; // dot(dir, dir)
+    alignas(32) float tMax[MaxRays];
+    alignas(32) int hitSphere[MaxRays];
+
+    void Set(int i, const glm::vec3& dir, float t, int hit);
+    // 用最后一条光线填充到 8 的倍数，内核按整组读取时不会读到未初始化的数据
+    void Pad();
+};
+
+// 光线包与 soa 中 candidates（SoA 位置）列出的球体求最近交点，SIMD 跨光线并行；
+// 比较规则与 RTClosestHitKernel 相同，每条光线的结果与逐条调用逐位一致
+typedef void (*RTPacketClosestHitKernel)(const RTSphereSoA& soa, const int* candidates, int candidateCount,
+                                         RTRayPacket& packet);
+
+// 一批方向（SoA）换算为等距柱状投影 UV，使用 RTFastMath.h 的近似；
+// 各指令集的结果与逐个调用 RTFastDirectionToUV 逐位一致
+typedef void (*RTDirectionToUVKernel)(const float* x, const float* y, const float* z, int count,
+                                      float* u, float* v);
+
+// 一批方向（SoA）换算为立方体贴图的面与面内坐标；各指令集的结果与逐个调用 RTDirectionToCube 逐位一致
+typedef void (*RTDirectionToCubeKernel)(const float* x, const float* y, const float* z, int count,
+                                        int* face, float* s, float* t);
+
+struct RTSimdKernels {
+    RTSimdLevel level;
+    RTClosestHitKernel closestHit;
+    RTAnyHitKernel anyHit;
+    RTPacketClosestHitKernel packetClosestHit;
+    RTDirectionToUVKernel directionToUV;
+    RTDirectionToCubeKernel directionToCube;
+};
+
+// 检测当前 CPU（且本次编译包含）的最高指令集
+RTSimdLevel RTDetectSimdLevel();
+
+// 返回指定指令集的内核；CPU 或编译不支持时逐级回退，SIMD_AUTO 等价于 RTDetectSimdLevel()
+RTSimdKernels RTGetSimdKernels(RTSimdLevel level);
+
+const char* RTSimdLevelName(RTSimdLevel level);
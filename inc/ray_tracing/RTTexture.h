@@ -0,0 +1,10 @@
+#pragma once
+#include <vector>
+
+// 8 位纹理，行优先存储，第一行为图像顶部
+struct RTTexture {
+    int width;
+    int height;
+    int channels;
+    std::vector<unsigned char> data;
+};
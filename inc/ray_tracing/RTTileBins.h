@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <glm.hpp>
+#include "RayTracingData.h"
+#include "RTSimd.h"
+
+// 主光线可见性的屏幕分格：每帧把每个球体在屏幕上的投影（椭圆）的包围矩形算出来，
+// 把球体登记到它覆盖的每个 BinSize x BinSize 像素格子里，类似分块光栅化的 binning
+// 主光线只需测试所在格子的球体，空格子直接采样环境
+class RTTileBins {
+public:
+    static const int BinSize = 8;
+
+    // 主光线从 cameraPos 出发，方向由 view / invProj 决定（同 RayTracer::PrimaryRayDir）
+    // 视图矩阵带缩放或投影无法反解时不分格（Valid() 为 false），调用方退回 BVH 遍历
+    void Build(const std::vector<RTSphereData>& spheres, const RTSphereSoA& soa,
+               const glm::vec3& cameraPos, const glm::mat4& view, const glm::mat4& invProj,
+               int width, int height);
+    void Clear() { valid = false; }
+
+    bool Valid() const { return valid; }
+
+    // 像素 (x, y) 所在格子的球体（SoA 位置，升序），可直接交给 packetClosestHit
+    const int* PixelSpheres(int x, int y, int& count) const {
+        int bin = (y / BinSize) * binsX + x / BinSize;
+        count = binStart[bin + 1] - binStart[bin];
+        return binSpheres.data() + binStart[bin];
+    }
+
+    // 像素范围 [x0, x1) x [y0, y1) 覆盖的各格子球体的并集（升序、无重复）
+    void Gather(int x0, int y0, int x1, int y1, std::vector<int>& out) const;
+
+    // 登记的球体条目总数（一个球体覆盖几个格子就计几次）
+    size_t EntryCount() const { return binSpheres.size(); }
+
+private:
+    struct BinRect {
+        int x0, y0, x1, y1; // 覆盖的格子范围（闭区间），x0 > x1 表示不在屏幕内
+    };
+
+    // 球体在屏幕上覆盖的格子范围
+    BinRect SphereBins(const glm::vec3& center, float radius) const;
+
+    bool valid = false;
+    int width = 0, height = 0;
+    int binsX = 0, binsY = 0;
+    std::vector<int> binStart;   // 格子 b 的球体为 binSpheres[binStart[b], binStart[b + 1])
+    std::vector<int> binSpheres;
+    std::vector<int> binFill;    // 构建时各格子的写入位置
+    std::vector<BinRect> rects;  // 构建时每个 SoA 位置的格子范围
+
+    // 投影参数：观察空间（以 cameraPos 为原点）旋转、斜率 -> NDC 的仿射映射
+    glm::dvec3 camera;
+    glm::dmat3 rotation;
+    glm::dmat2 slopeToNdc;
+    glm::dvec2 slopeOffset;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// 屏幕上的一个矩形分块 [x0, x1) x [y0, y1)
+struct RTTile {
+    int x0, y0;
+    int x1, y1;
+};
+
+// 内置分块线程池：整帧切成 tileSize x tileSize 的小块，
+// 每个线程先处理自己队列里连续的一段块，做完后再从其他线程的队尾“窃取”
+class RTTileScheduler {
+public:
+    explicit RTTileScheduler(int threadCount = 0); // 0 表示使用硬件线程数
+    ~RTTileScheduler();
+
+    void SetThreadCount(int threadCount);
+    int GetThreadCount() const { return threadCount; }
+
+    // 阻塞执行一帧：对每个分块调用 fn(tile, threadIndex)，threadIndex ∈ [0, GetThreadCount())
+    // 调用线程自身作为 0 号线程参与计算
+    void Run(int width, int height, int tileSize, const std::function<void(const RTTile&, int)>& fn);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<int> tiles; // 分块下标
+    };
+
+    void StartWorkers();
+    void StopWorkers();
+    void WorkerLoop(int threadIndex, unsigned long long seenFrame);
+    void ProcessTiles(int threadIndex);
+    bool PopTile(int threadIndex, int& tileIndex);
+
+    int threadCount = 1;
+    std::vector<std::thread> workers;       // 1..threadCount-1 号线程
+    std::vector<WorkQueue> queues;          // 每个线程一个队列
+
+    std::mutex frameMutex;
+    std::condition_variable frameStart;
+    std::condition_variable frameDone;
+    unsigned long long frameId = 0;         // 每次 Run 递增，用于唤醒工作线程
+    int pendingWorkers = 0;                 // 尚未完成本帧的工作线程数
+    bool stopping = false;
+
+    // 当前帧的任务（只在 Run 期间有效）
+    std::vector<RTTile> tiles;
+    const std::function<void(const RTTile&, int)>* job = nullptr;
+};
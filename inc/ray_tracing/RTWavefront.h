@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <glm.hpp>
+#include "RTRandom.h"
+#include "RTKernels.h"
+
+// 阴影光线：未被遮挡时把 contribution 加到着色点的直接光照上
+struct RTShadowRay {
+    glm::vec3 origin;
+    float maxT;                // 到光源中心的距离
+    glm::vec3 dir;
+    int skipA, skipB;          // 不参与遮挡测试的球体（着色点所在的球体与光源）
+    glm::vec3 contribution;    // 该光源的 Phong 漫反射 + 镜面反射（已乘光源采样权重）
+};
+
+// 波前引擎按击中结果把光线分成的类别，着色时每类连续处理
+enum RTWavefrontClass {
+    WAVEFRONT_MISS,        // 未击中：环境贴图
+    WAVEFRONT_EMISSIVE,    // 击中光源：自发光
+    WAVEFRONT_SHADE,       // 漫反射（以及深度用完的镜面 / 折射）：直接光照，产生阴影光线
+    WAVEFRONT_SPECULAR,    // 镜面反射：产生下一层光线
+    WAVEFRONT_REFRACTIVE,  // 折射：产生下一层光线
+    WAVEFRONT_CLASS_COUNT
+};
+
+// 波前引擎的队列，一批像素（路径）共用，跨帧复用内存
+struct RTWavefrontQueues {
+    struct Ray {
+        glm::vec3 origin;
+        glm::vec3 dir;
+        int path;              // 所属路径（批内像素下标）
+        RTRayCone cone;        // 纹理 mip 级别选择
+    };
+    struct Bounce {
+        int path;
+        glm::vec3 albedo;
+    };
+
+    // 每条路径
+    std::vector<RTRandom> rng;
+    std::vector<glm::vec3> color;          // 路径末端的颜色，逆序乘上各层反照率后为像素颜色
+
+    // 当前层的光线与最近交点
+    std::vector<Ray> rays, nextRays;
+    std::vector<int> hitSphere;
+    std::vector<float> hitT;
+    std::vector<unsigned char> hitClass;   // RTWavefrontClass
+    std::vector<int> sorted;               // 按类别稳定排序后的光线下标
+    int classBegin[WAVEFRONT_CLASS_COUNT + 1];
+
+    // 未击中光线的方向与 UV（SoA），MATH_PRECISION_FAST 时用 SIMD 批量换算；
+    // 环境贴图为立方体贴图时 missU / missV 为面内坐标，missFace 为所在的面
+    std::vector<float> missX, missY, missZ, missU, missV;
+    std::vector<int> missFace;
+
+    // 直接光照：每个着色点固定 lightIterations 个阴影光线槽，着色点分段处理时各段复用
+    std::vector<glm::vec3> shadeColor;     // 环境光项，之后累加未被遮挡的光源
+    std::vector<RTShadowRay> shadowRays;
+    std::vector<unsigned char> shadowState; // 0: 槽位未使用，1: 未遮挡，2: 被遮挡
+
+    // 每层镜面 / 折射反弹记录的反照率
+    std::vector<std::vector<Bounce>> bounces;
+};
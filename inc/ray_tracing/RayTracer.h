@@ -1,13 +1,144 @@
 #pragma once
 #include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 #include <glm.hpp>
 #include "RayTracingData.h"
+#include "RTTexture.h"
+#include "RTKernels.h"
+#include "RTTileScheduler.h"
+#include "RTBVH.h"
+#include "RTSimd.h"
+#include "RTScene.h"
+#include "RTLightList.h"
+#include "RTRandom.h"
+#include "RTFrameBuffers.h"
+#include "RTWavefront.h"
+#include "RTTileBins.h"
+#include "RTCubemap.h"
 
-struct RTTexture {
-    int width;
-    int height;
-    int channels;
-    std::vector<unsigned char> data;
+// 多线程调度方式
+enum RTSchedulerType {
+    SCHEDULER_OPENMP,    // OpenMP 按行动态调度（未启用 OpenMP 编译时退化为 SCHEDULER_TILE_POOL）
+    SCHEDULER_TILE_POOL  // 内置线程池：分块 + 工作窃取
+};
+
+// 追踪引擎
+enum RTTraceEngine {
+    ENGINE_DEPTH_FIRST, // 每个像素独立追踪完整路径
+    ENGINE_WAVEFRONT    // 一批像素逐层推进：批量求交，按材质分类后分别着色，阴影光线批量测试；结果与 ENGINE_DEPTH_FIRST 相同
+};
+
+// 物体表面与环境贴图的纹理过滤
+enum RTTextureFilter {
+    TEXTURE_FILTER_POINT,     // 原图最近点采样
+    TEXTURE_FILTER_BILINEAR,  // mip 第 0 级双线性采样
+    TEXTURE_FILTER_TRILINEAR  // 按光锥足迹选择 mip 级别，两级之间三线性插值
+};
+
+// 调试视图：用热力图替换追踪结果，观察各区域的开销
+enum RTDebugView {
+    DEBUG_VIEW_NONE,
+    DEBUG_VIEW_PIXEL_TIME,   // 每像素追踪耗时
+    DEBUG_VIEW_TILE_TIME,    // 每个分块的追踪耗时（SCHEDULER_OPENMP 下为每个调度的行或横带）
+    DEBUG_VIEW_SPHERE_TESTS, // 每像素的射线-球体求交测试次数（含阴影光线）
+    DEBUG_VIEW_DEPTH         // 每像素到达的最深递归层
+};
+
+struct RTRenderOptions {
+    RTSchedulerType scheduler = SCHEDULER_TILE_POOL;
+    int threadCount = 0;   // 0 表示使用全部硬件线程
+    int tileSize = 16;     // SCHEDULER_TILE_POOL 的分块边长（像素）
+    // BVH 每帧优先 refit；refit 后 SAH 代价超过构建时的该倍数则完全重建，<= 0 表示每帧重建
+    float bvhRebuildThreshold = 1.5f;
+    RTSimdLevel simdLevel = SIMD_AUTO; // 球体求交内核的指令集，不支持时自动回退
+    // 直接光照：0 表示遍历全部光源；> 0 时每个着色点按功率随机选取该数量的光源（光源很多时使用）
+    int lightSampleCount = 0;
+    // 渐进模式：相机与场景静止时每帧为每个像素累加一个抖动采样，逐帧收敛为抗锯齿图像
+    bool progressive = false;
+    int progressiveMaxSamples = 0; // 累计达到该采样数后不再追踪（0 表示不限）
+    // 内部追踪分辨率 = 窗口分辨率 * renderScale，由显示端（RTPresenter）放大到窗口
+    float renderScale = 1.0f;
+    // 动态分辨率：根据 Render 耗时在 [minRenderScale, maxRenderScale] 内调整 renderScale，
+    // 使每帧耗时接近 targetFrameMs（renderScale 作为初始值）
+    bool dynamicResolution = false;
+    float targetFrameMs = 16.0f;
+    float minRenderScale = 0.25f;
+    float maxRenderScale = 1.0f;
+    RTTraceEngine engine = ENGINE_DEPTH_FIRST;
+    // ENGINE_DEPTH_FIRST 的主光线包边长（2..8 像素）：包的视锥在 BVH 中一次剔除球体，剩余球体
+    // 用 SIMD 同时测试包内所有光线；<= 1 表示逐像素追踪。逐像素调试视图下不使用
+    int packetSize = 8;
+    // 主光线可见性：每帧把球体按屏幕投影登记到 8x8 像素的格子，主光线只测试所在格子的球体
+    bool tileBinning = true;
+    RTTextureFilter textureFilter = TEXTURE_FILTER_TRILINEAR;
+    // mip 纹素的存储顺序（POINT 过滤直接读原图，不受影响）；修改时转换已注册的全部纹理
+    // ray_tracing_kernel_bench 的 layout_* 中 TILED 目前慢于 LINEAR，因此只作为可选项
+    RTTextureLayout textureLayout = TEXTURE_LAYOUT_LINEAR;
+    // 球面 UV 的 atan2 / asin 与 Phong 高光的 pow：FAST 用 RTFastMath.h 的多项式近似，
+    // 参考渲染用 ACCURATE（libm）
+    RTMathPrecision mathPrecision = MATH_PRECISION_FAST;
+    // 非 DEBUG_VIEW_NONE 时输出热力图（黑-蓝-青-绿-黄-红-白），此时不做渐进累加，并总是使用 ENGINE_DEPTH_FIRST
+    RTDebugView debugView = DEBUG_VIEW_NONE;
+};
+
+// 每帧耗时统计，用于观察多线程的利用率（相对单线程的实际加速比见 ray_tracing_bench 的 1..N 线程测量）
+struct RTFrameTiming {
+    double frameMs = 0.0;  // Render 的墙钟时间
+    double busyMs = 0.0;   // 所有线程追踪耗时之和
+    int threads = 1;       // 本帧实际使用的线程数
+    double bvhMs = 0.0;    // 加速结构更新耗时
+    bool bvhRebuilt = false; // 本帧 BVH 是完全重建（否则为 refit）
+    int accumulatedSamples = 0; // 渐进模式下当前图像的每像素采样数（非渐进模式为 1）
+    float renderScale = 1.0f;   // 本帧的追踪分辨率比例
+    int renderWidth = 0, renderHeight = 0;
+    uint64_t rays = 0;     // 本帧追踪的光线数（主光线、反射 / 折射光线与阴影光线）
+
+    // 平均同时忙碌的线程数（busyMs / frameMs），不是相对单线程的加速比：线程间争用缓存与内存带宽时
+    // 每个线程的追踪变慢，该值仍然接近线程数
+    double Parallelism() const { return frameMs > 0.0 ? busyMs / frameMs : 0.0; }
+    // Parallelism 占线程数的比例（线程在本帧墙钟时间内的忙碌比例）
+    double Utilization() const { return threads > 0 ? Parallelism() / threads : 0.0; }
+};
+
+// 光线与求交计数：追踪时累加到线程局部的副本，每个分块结束时并入该线程的合计，帧末汇总
+struct RTRayCounters {
+    static const int DepthBins = 8;
+
+    uint64_t primaryRays = 0;
+    uint64_t secondaryRays = 0;      // 反射 / 折射光线
+    uint64_t shadowRays = 0;
+    uint64_t leafVisits = 0;         // BVH 叶子访问次数（最近交点与阴影查询）
+    uint64_t sphereTests = 0;        // 射线-球体求交测试次数（访问到的叶子中的球体数之和）
+    uint64_t textureSamples = 0;     // 物体表面纹理采样
+    uint64_t environmentSamples = 0; // 未击中任何物体时的环境贴图采样
+    uint64_t depthHistogram[DepthBins] = {}; // 各递归层的光线数，0 为主光线，更深的计入最后一格
+
+    uint64_t TotalRays() const { return primaryRays + secondaryRays + shadowRays; }
+    void Add(const RTRayCounters& other);
+};
+
+// 每帧的渲染统计，用于定位生产场景中的热点
+struct RTFrameStats {
+    RTRayCounters counters;
+    double sceneUpdateMs = 0.0; // BVH、SoA 镜像与光源列表的增量更新
+    double binningMs = 0.0;     // 主光线的屏幕分格（RTTileBins::Build）
+    double traceMs = 0.0;       // 并行追踪（生成主光线、求交、着色、写入像素）的墙钟时间
+    double presentMs = 0.0;     // 交给显示端（纹理上传或 PBO 拷贝命令的提交）
+    double frameMs = 0.0;       // 同 RTFrameTiming::frameMs，不含 presentMs
+    int renderWidth = 0, renderHeight = 0;
+    // 调试视图中最亮的颜色对应的值（微秒 / 测试次数 / 递归层），更大的值截断到该颜色
+    double debugScaleMax = 0.0;
+
+    double RaysPerSecond() const { return frameMs > 0.0 ? counters.TotalRays() * 1000.0 / frameMs : 0.0; }
+};
+
+// 已知的一段光线的最近交点（主光线包求出），sphere < 0 表示未击中
+struct RTRayHit {
+    int sphere;
+    float t;
 };
 
 class RayTracer {
@@ -16,48 +147,269 @@ public:
     ~RayTracer();
 
     void Resize(int width, int height);
+
+    void SetOptions(const RTRenderOptions& options);
+    const RTRenderOptions& GetOptions() const { return options; }
+    const RTFrameTiming& GetFrameTiming() const { return frameTiming; }
+    // 最近一次显示的帧的光线计数与各阶段耗时
+    const RTFrameStats& GetFrameStats() const { return frameStats; }
+
+    // 丢弃渐进模式已累加的采样，下一帧重新开始（异步模式下等待正在追踪的帧完成）
+    // 相机、投影、场景、选项、纹理或分辨率变化时会自动调用
+    void ResetAccumulation();
+    int GetAccumulatedSamples() const { return frameTiming.accumulatedSamples; }
+
+    // 最近一次显示的帧的追踪分辨率（动态分辨率下逐帧变化）
+    float GetRenderScale() const { return frameTiming.renderScale; }
+    int GetRenderWidth() const { return frameTiming.renderWidth; }
+    int GetRenderHeight() const { return frameTiming.renderHeight; }
+
+    // 纹理库：纹理只在注册时拷贝（或移动）一次，之后每帧通过句柄引用
+    RTTextureHandle RegisterTexture(const RTTexture& tex);
+    RTTextureHandle RegisterTexture(RTTexture&& tex);
+    void ReleaseTexture(RTTextureHandle handle);
+    const RTTexture* GetTexture(RTTextureHandle handle) const;
     
     // 执行 CPU 光线追踪计算
+    // 场景在帧间持久保存，只根据脏标记增量更新加速结构（会清除 scene 的脏标记）
+    void Render(RTScene& scene,
+                const glm::vec3& cameraPos,
+                const glm::mat4& view,
+                const glm::mat4& projection,
+                const float traceTimes);
+
+    // 兼容接口：每帧传入完整数组，内部同步到一个 RTScene 后渲染
+    // materialTextures[materialIndex] 为该材质使用的纹理句柄（RT_INVALID_TEXTURE 表示只用材质颜色）
     void Render(const std::vector<RTSphereData>& spheres, 
                 const std::vector<RTMaterial>& materials,
-                const std::vector<RTTexture>& textures, // 新增纹理数据
+                const std::vector<RTTextureHandle>& materialTextures,
                 const glm::vec3& cameraPos, 
                 const glm::mat4& view, 
                 const glm::mat4& projection,
                 const float traceTimes);
     
-    void SetEnvironmentTexture(const RTTexture& env);
-    
-    // 将计算结果绘制到屏幕上
-    void DrawResult();
+    // 异步模式：提交一帧后立即返回，由后台线程追踪，主循环不被追踪耗时阻塞
+    // 后台线程忙时新的提交会覆盖尚未开始的旧提交（只追踪最新的相机）；场景在提交时拷贝（会清除脏标记）
+    void SubmitFrame(RTScene& scene,
+                     const glm::vec3& cameraPos,
+                     const glm::mat4& view,
+                     const glm::mat4& projection,
+                     const float traceTimes);
+    // 若有新完成的帧则交给帧输出缓冲显示并返回 true，否则立即返回 false（继续显示上一帧）
+    bool TryGetLatestFrame();
+
+    // 等距柱状投影的环境贴图；toCubemap 时在此一次性转换为立方体贴图（faceSize <= 0 时取宽度的 1 / 4），
+    // 之后未击中的光线只需选出主轴并做一次除法，不再计算 atan2 / asin
+    void SetEnvironmentTexture(const RTTexture& env, bool toCubemap = false, int faceSize = 0);
+    // 直接使用立方体贴图的六个面（顺序 +X -X +Y -Y +Z -Z，同 loadCubemap），各面须为大小相同的正方形；
+    // 不符合时返回 false，并保持原来的环境贴图
+    bool SetEnvironmentCubemap(const std::vector<RTTexture>& faces);
+
+    // 最近一次显示的帧：RGB，GetRenderWidth() x GetRenderHeight()，第一行为图像顶部
+    // 在下一次 Render / SubmitFrame / TryGetLatestFrame 之前有效；还没有帧时返回 nullptr
+    const unsigned char* GetPixels() const;
+    // 渐进模式下已累加的平均颜色（未截断的浮点值，顺序同 GetPixels）；只用于同步 Render
+    bool GetAccumulatedImage(std::vector<glm::vec3>& out) const;
+
+    // 追踪结果的输出位置，默认为内部的内存缓冲；传入 RTPresenter 可直接写入 PBO 并显示
+    // buffers 由调用方持有，生命周期须长于 RayTracer（或之后重新设置）；nullptr 恢复默认
+    void SetFrameBuffers(RTFrameBuffers* buffers);
 
 private:
-    int width, height;
-    std::vector<unsigned char> pixelBuffer; // RGB 数据 (width * height * 3)
-    unsigned int textureID;
-    unsigned int quadVAO = 0, quadVBO;
-    unsigned int screenShaderProgram = 0;
+    int width, height;             // 输出（窗口）分辨率，纹理按此大小分配
+    int renderWidth, renderHeight; // 实际追踪的分辨率，结果写入输出缓冲的左上部分
+    float renderScale = 1.0f;
+    double smoothedFrameMs = 0.0;  // 动态分辨率使用的平滑帧耗时
+    RTMemoryFrameBuffers memoryBuffers;   // 默认的输出缓冲
+    RTFrameBuffers* frameBuffers;         // 追踪结果直接写入其中的缓冲
+    unsigned char* traceTarget = nullptr; // 本帧写入的缓冲，RGB (renderWidth * renderHeight * 3)
+
+    RTRenderOptions options;
+    RTTileScheduler tileScheduler;
+    RTFrameTiming frameTiming;  // 最近一次显示的帧
+    RTFrameTiming traceTiming;  // 正在追踪的帧（异步模式下只由工作线程访问）
+    RTFrameStats frameStats;    // 同 frameTiming
+    RTFrameStats traceStats;    // 同 traceTiming
+    RTBVH bvh; // 每次 Render 开始时根据 spheres 更新（refit 或重建）
+    RTSphereSoA sphereSoA;      // 按 bvh 叶子顺序排列的球体 SoA 镜像
+    RTSimdKernels simdKernels;  // 当前使用的求交内核
+    RTLightList lightList;      // 场景中的发光球体
+    RTTileBins tileBins;        // 本帧主光线的屏幕分格（options.tileBinning）
+    uint32_t frameIndex = 0;    // 帧计数，参与随机数种子
+    int frameDepth = 0;         // 本帧的最大递归深度，Trace 据此计算当前递归层
+    float pixelSpreadAngle = 0.0f; // 本帧一个像素的张角（弧度），主光线光锥的展开角
+
+    std::vector<float> debugBuffer; // 调试视图的逐像素数值 (renderWidth * renderHeight)
+    RTWavefrontQueues wavefront;    // ENGINE_WAVEFRONT 的队列
+
+    // 本帧每个线程的追踪耗时与计数，TraceFrame 末尾汇总
+    bool frameUseOpenMP = false;
+    std::vector<double> threadBusyMs;
+    std::vector<RTRayCounters> threadCounters;
+
+    // 渐进累加
+    std::vector<glm::vec3> accumBuffer; // 每像素颜色之和 (width * height)
+    int accumulatedSamples = 0;
+    glm::vec3 lastCameraPos = glm::vec3(0.0f);
+    glm::mat4 lastView = glm::mat4(0.0f), lastProjection = glm::mat4(0.0f);
+    int lastDepth = -1;
+
+    RTScene legacyScene;                // 数组版 Render 使用的内部场景
+    const RTScene* lastScene = nullptr; // 上一帧渲染的场景，换场景时完全重建派生数据
+
+    // frameBuffers 中每个缓冲的状态：空闲 -> 追踪中 -> 待显示 -> 已显示（等待显示端用完）-> 空闲
+    enum SlotState { SLOT_FREE, SLOT_TRACING, SLOT_READY, SLOT_PRESENTED };
+    int slotState[RTFrameBuffers::SlotCount];
+    RTFrameTiming slotTiming[RTFrameBuffers::SlotCount];
+    RTFrameStats slotStats[RTFrameBuffers::SlotCount];
+    int readySlot = -1;     // 最新完成、尚未显示的缓冲
+    int presentedSlot = -1; // 最近一次显示的缓冲
+
+    // 异步流水线：工作线程写入空闲缓冲，完成后成为 readySlot；TryGetLatestFrame 再显示它
+    std::thread asyncThread;
+    std::mutex asyncMutex;
+    std::condition_variable asyncCv;  // 有新提交或需要退出
+    std::condition_variable idleCv;   // 工作线程完成一帧
+    bool asyncStop = false;
+    bool asyncBusy = false;
+    bool hasSubmit = false;
+    bool submitSceneChanged = false;
+    std::vector<RTSphereData> submitSpheres;
+    std::vector<RTMaterial> submitMaterials;
+    std::vector<RTTextureHandle> submitMaterialTextures;
+    glm::vec3 submitCameraPos = glm::vec3(0.0f);
+    glm::mat4 submitView = glm::mat4(1.0f), submitProjection = glm::mat4(1.0f);
+    float submitTraceTimes = 0.0f;
+    const RTScene* lastSubmittedScene = nullptr;
+    RTScene asyncScene;                 // 工作线程渲染的场景副本
+
+    void AsyncWorkerLoop();
+    // 等待工作线程空闲并持有锁，期间工作线程不会开始新的一帧
+    std::unique_lock<std::mutex> LockAsyncIdle();
+    // ResetAccumulation 的实现：调用方已持有 LockAsyncIdle 的锁，或者就是追踪中的线程
+    void ClearAccumulation();
+    void StopAsync();
+
+    // 以下缓冲管理函数只在主线程（显示端所在线程）且持有 asyncMutex 时调用
+    void ReclaimSlots();       // 显示端已用完的缓冲回到空闲状态
+    int FindFreeSlot() const;
+    int AcquireSlot();         // 工作线程空闲时为同步渲染取一个缓冲（必要时等待显示端）
+    void PresentSlot(int slot);
+
+    // 追踪一帧到 traceTarget；渐进模式已收敛、无需追踪时返回 false
+    bool TraceFrame(RTScene& scene,
+                    const glm::vec3& cameraPos,
+                    const glm::mat4& view,
+                    const glm::mat4& projection,
+                    const float traceTimes);
 
-    // 光线追踪核心函数
+    // 按 scale 计算追踪分辨率，变化时重新分配缓冲
+    void ApplyRenderScale(float scale);
+    // 根据本帧耗时调整下一帧的 renderScale
+    void UpdateDynamicResolution(double frameMs);
+
+    // 在 [0, count) 上以 chunkSize 为单位并行执行 fn(begin, end)，使用本帧选定的调度方式并汇总线程统计
+    void ParallelFor(int count, int chunkSize, const std::function<void(int, int)>& fn);
+    static RTRayCounters& ThreadCounters(); // 当前线程的计数（ParallelFor 的每段结束时汇总）
+    // ENGINE_WAVEFRONT：按批追踪全部像素并写入 traceTarget
+    void TraceWavefront(const std::vector<RTSphereData>& spheres,
+                        const std::vector<RTMaterial>& materials,
+                        const std::vector<RTTextureHandle>& materialTextures,
+                        const glm::vec3& cameraPos,
+                        const glm::mat4& invView,
+                        const glm::mat4& invProj,
+                        int depth);
+    void TraceWavefrontBatch(int firstPixel, int pixelCount,
+                             const std::vector<RTSphereData>& spheres,
+                             const std::vector<RTMaterial>& materials,
+                             const std::vector<RTTextureHandle>& materialTextures,
+                             const glm::vec3& cameraPos,
+                             const glm::mat4& invView,
+                             const glm::mat4& invProj,
+                             int depth);
+    static const int WavefrontBatchSize = 1 << 16; // 每批像素数，限制队列的内存
+    static const int WavefrontShadowBudget = 1 << 18; // 每段着色点的阴影光线槽数上限（约 13 MB），光源很多时分段
+
+    // 把 debugBuffer 按颜色梯度写入 traceTarget，返回最亮颜色对应的值
+    double WriteDebugHeatmap(RTDebugView view);
+
+    // 根据场景脏标记更新 bvh / sphereSoA / lightList
+    void UpdateSceneData(RTScene& scene);
+
+    // 光线追踪核心函数：沿镜面 / 折射路径迭代，最多反弹 maxDepth 次，最终在漫反射表面做直接光照
     glm::vec3 Trace(const glm::vec3& origin, const glm::vec3& dir, 
                    const std::vector<RTSphereData>& spheres, 
                    const std::vector<RTMaterial>& materials, 
-                   const std::vector<RTTexture>& textures, // 新增
-                   int depth);
-    
-    // 辅助函数：求交
-    bool IntersectSphere(const glm::vec3& origin, const glm::vec3& dir, 
-                        const RTSphereData& sphere, float& t);
-    
-    // 辅助函数：纹理采样
-    glm::vec3 SampleTexture(const RTTexture& tex, float u, float v);
+                   const std::vector<RTTextureHandle>& materialTextures,
+                   int maxDepth,
+                   RTRandom& rng,
+                   const RTRayHit* primaryHit = nullptr); // 非空时跳过第一段的求交
+    // 主光线的光锥：起点宽度为 0，展开角为一个像素的张角
+    RTRayCone PrimaryCone() const { return RTRayCone{0.0f, pixelSpreadAngle}; }
+    static const int PathStackSize = 16; // Trace 在栈上记录的反弹次数，更深的路径使用堆内存
+
+    // 击中点的反照率：材质颜色，绑定纹理时为球面纹理采样结果；footprint 为光锥在球面上的张角，用于选择 mip 级别
+    glm::vec3 SurfaceAlbedo(const RTSphereData& hitSphere, const RTMaterial& hitMat, const glm::vec3& normal,
+                            float footprint, const std::vector<RTTextureHandle>& materialTextures);
+    // 镜面 / 折射材质：把 origin、dir 更新为下一段光线并返回 true；其他材质返回 false
+    bool NextBounce(const RTMaterial& hitMat, const glm::vec3& hitPoint, const glm::vec3& normal,
+                    glm::vec3& origin, glm::vec3& dir);
+    // 环境光 + 各光源的阴影测试与 Phong 着色，结果截断到 [0, 1]
+    glm::vec3 ShadeDirect(const glm::vec3& hitPoint, const glm::vec3& normal, const glm::vec3& dir,
+                          const glm::vec3& albedo, int hitSphereIdx, RTRandom& rng);
     
-    glm::vec3 SampleEnvironment(const glm::vec3& dir);
+    // 阴影光线数（lightSampleCount 生效时为采样数），sampleLights 表示是否按功率随机选取
+    int LightIterations(bool& sampleLights) const;
+    // 第 k 个光源的阴影光线与未遮挡时的贡献；光源就是着色点所在的球体时返回 false
+    bool SampleLight(int k, bool sampleLights, const glm::vec3& hitPoint, const glm::vec3& normal,
+                     const glm::vec3& viewDir, const glm::vec3& albedo, int hitSphereIdx,
+                     RTRandom& rng, RTShadowRay& shadow);
+    bool Occluded(const RTShadowRay& shadow);
+
+    // 像素的随机序列、主光线方向（渐进模式下抖动）与颜色写入（含渐进累加）
+    RTRandom PixelRandom(int x, int y) const;
+    glm::vec3 PrimaryRayDir(int x, int y, const glm::mat4& invView, const glm::mat4& invProj, RTRandom& rng) const;
+    // 穿过追踪分辨率下屏幕坐标 (px, py) 的光线方向（未归一化）
+    glm::vec3 ScreenRayDir(float px, float py, const glm::mat4& invView, const glm::mat4& invProj) const;
+    void WritePixel(int x, int y, glm::vec3 color);
+
+    // 追踪单个像素并写入 traceTarget
+    void RenderPixel(int x, int y,
+                     const std::vector<RTSphereData>& spheres,
+                     const std::vector<RTMaterial>& materials,
+                     const std::vector<RTTextureHandle>& materialTextures,
+                     const glm::vec3& cameraPos,
+                     const glm::mat4& invView,
+                     const glm::mat4& invProj,
+                     int depth);
+
+    // 用 tileBins 求像素 (x, y) 的主光线 dir 的最近交点；本帧没有分格时返回 false
+    bool BinnedPrimaryHit(int x, int y, const glm::vec3& origin, const glm::vec3& dir, RTRayHit& hit);
+
+    // 以主光线包追踪 [x0, x1) x [y0, y1)（不超过 8x8）并写入 traceTarget
+    void RenderPacket(int x0, int y0, int x1, int y1,
+                      const std::vector<RTSphereData>& spheres,
+                      const std::vector<RTMaterial>& materials,
+                      const std::vector<RTTextureHandle>& materialTextures,
+                      const glm::vec3& cameraPos,
+                      const glm::mat4& invView,
+                      const glm::mat4& invProj,
+                      int depth);
+
+    // 环境贴图采样（没有环境贴图时为黑色），spread 为光锥展开角；求交与纹理采样见 RTKernels.h
+    glm::vec3 SampleEnvironment(const glm::vec3& dir, float spread);
+    // 同上，方向已换算为 UV（ENGINE_WAVEFRONT 用 simdKernels.directionToUV 批量换算）
+    glm::vec3 SampleEnvironmentUV(float u, float v, float spread);
+    // 同上，环境贴图为立方体贴图，方向已换算为面与面内坐标（ENGINE_WAVEFRONT 用 simdKernels.directionToCube）
+    glm::vec3 SampleEnvironmentCube(int face, float s, float t, float spread);
 
-    void InitGLResources();
-    void SetupScreenShader();
     
+    std::vector<RTTexture> textureRegistry; // 下标即句柄
+    std::vector<RTMipTexture> mipRegistry;  // 与 textureRegistry 一一对应，注册时生成
+
     RTTexture environmentTexture;
+    RTMipTexture environmentMip;
+    RTCubemap environmentCube;  // 非空时取代 environmentTexture / environmentMip
     bool hasEnvironmentTexture = false;
     float environmentIntensity = 1.5;
 };
@@ -0,0 +1,221 @@
+#include "RTBVH.h"
+
+namespace {
+    const int SAHBinCount = 12;     // SAH 分桶数
+    const float TraversalCost = 1.0f;    // 遍历一个内部节点的相对代价
+    const float IntersectCost = 1.0f;    // 一次球体求交的相对代价
+
+    float SurfaceArea(const glm::vec3& bmin, const glm::vec3& bmax) {
+        glm::vec3 e = bmax - bmin;
+        return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+
+    struct SAHBin {
+        glm::vec3 bmin = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 bmax = glm::vec3(-std::numeric_limits<float>::max());
+        int count = 0;
+    };
+}
+
+void RTBVH::Clear() {
+    nodes.clear();
+    primIndices.clear();
+    builtSAHCost = 0.0f;
+}
+
+bool RTBVH::Update(const std::vector<RTSphereData>& spheres, float rebuildThreshold) {
+    if (nodes.empty() || primIndices.size() != spheres.size() || rebuildThreshold <= 0.0f) {
+        Build(spheres);
+        return true;
+    }
+    Refit(spheres);
+    if (ComputeSAHCost() > builtSAHCost * rebuildThreshold) {
+        Build(spheres);
+        return true;
+    }
+    return false;
+}
+
+void RTBVH::Refit(const std::vector<RTSphereData>& spheres) {
+    int n = static_cast<int>(spheres.size());
+    for (int i = 0; i < n; ++i) {
+        glm::vec3 r(spheres[i].radius);
+        primMin[i] = spheres[i].center - r;
+        primMax[i] = spheres[i].center + r;
+        primCentroid[i] = spheres[i].center;
+    }
+    // 孩子节点总是排在父节点之后，倒序遍历即可自底向上更新
+    for (int i = static_cast<int>(nodes.size()) - 1; i >= 0; --i) {
+        RTBVHNode& node = nodes[i];
+        if (node.count > 0) {
+            UpdateNodeBounds(i);
+        } else {
+            const RTBVHNode& left = nodes[node.leftFirst];
+            const RTBVHNode& right = nodes[node.leftFirst + 1];
+            node.boundsMin = glm::min(left.boundsMin, right.boundsMin);
+            node.boundsMax = glm::max(left.boundsMax, right.boundsMax);
+        }
+    }
+}
+
+float RTBVH::ComputeSAHCost() const {
+    if (nodes.empty()) return 0.0f;
+    float rootArea = SurfaceArea(nodes[0].boundsMin, nodes[0].boundsMax);
+    if (rootArea <= 0.0f) return 0.0f;
+    float cost = 0.0f;
+    for (const RTBVHNode& node : nodes) {
+        float area = SurfaceArea(node.boundsMin, node.boundsMax);
+        cost += area * (node.count > 0 ? node.count * IntersectCost : TraversalCost);
+    }
+    return cost / rootArea;
+}
+
+void RTBVH::Build(const std::vector<RTSphereData>& spheres) {
+    int n = static_cast<int>(spheres.size());
+    nodes.clear();
+    primIndices.resize(n);
+    if (n == 0) return;
+
+    primMin.resize(n);
+    primMax.resize(n);
+    primCentroid.resize(n);
+    for (int i = 0; i < n; ++i) {
+        glm::vec3 r(spheres[i].radius);
+        primMin[i] = spheres[i].center - r;
+        primMax[i] = spheres[i].center + r;
+        primCentroid[i] = spheres[i].center;
+        primIndices[i] = i;
+    }
+
+    nodes.reserve(2 * n - 1);
+    RTBVHNode root;
+    root.leftFirst = 0;
+    root.count = n;
+    nodes.push_back(root);
+    UpdateNodeBounds(0);
+
+    // 用显式栈代替递归，避免大场景下的深递归
+    std::vector<BuildEntry> buildStack;
+    buildStack.push_back({0, 0});
+    while (!buildStack.empty()) {
+        BuildEntry entry = buildStack.back();
+        buildStack.pop_back();
+
+        RTBVHNode node = nodes[entry.nodeIndex];
+        if (node.count <= 1 || entry.depth >= MaxDepth - 2) continue;
+
+        int axis;
+        float splitPos;
+        float splitCost = FindBestSplit(node, axis, splitPos);
+        float leafCost = node.count * IntersectCost;
+        if (axis < 0) continue;                                      // 球心全部重合，无法划分
+        if (splitCost >= leafCost && node.count <= MaxLeafSize) continue; // 划分不划算
+
+        // 按划分平面原地分区
+        int i = node.leftFirst;
+        int j = i + node.count - 1;
+        while (i <= j) {
+            if (primCentroid[primIndices[i]][axis] < splitPos) {
+                ++i;
+            } else {
+                std::swap(primIndices[i], primIndices[j--]);
+            }
+        }
+        int leftCount = i - node.leftFirst;
+        if (leftCount == 0 || leftCount == node.count) continue;
+
+        int leftIndex = static_cast<int>(nodes.size());
+        RTBVHNode left, right;
+        left.leftFirst = node.leftFirst;
+        left.count = leftCount;
+        right.leftFirst = i;
+        right.count = node.count - leftCount;
+        nodes.push_back(left);
+        nodes.push_back(right);
+        UpdateNodeBounds(leftIndex);
+        UpdateNodeBounds(leftIndex + 1);
+
+        nodes[entry.nodeIndex].leftFirst = leftIndex;
+        nodes[entry.nodeIndex].count = 0;
+
+        buildStack.push_back({leftIndex + 1, entry.depth + 1});
+        buildStack.push_back({leftIndex, entry.depth + 1});
+    }
+    builtSAHCost = ComputeSAHCost();
+}
+
+void RTBVH::UpdateNodeBounds(int nodeIndex) {
+    RTBVHNode& node = nodes[nodeIndex];
+    node.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+    node.boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+    for (int i = 0; i < node.count; ++i) {
+        int prim = primIndices[node.leftFirst + i];
+        node.boundsMin = glm::min(node.boundsMin, primMin[prim]);
+        node.boundsMax = glm::max(node.boundsMax, primMax[prim]);
+    }
+}
+
+float RTBVH::FindBestSplit(const RTBVHNode& node, int& bestAxis, float& bestPos) const {
+    bestAxis = -1;
+    bestPos = 0.0f;
+    float bestCost = std::numeric_limits<float>::max();
+
+    // 以球心的包围盒分桶
+    glm::vec3 cMin(std::numeric_limits<float>::max());
+    glm::vec3 cMax(-std::numeric_limits<float>::max());
+    for (int i = 0; i < node.count; ++i) {
+        const glm::vec3& c = primCentroid[primIndices[node.leftFirst + i]];
+        cMin = glm::min(cMin, c);
+        cMax = glm::max(cMax, c);
+    }
+
+    float parentArea = SurfaceArea(node.boundsMin, node.boundsMax);
+    if (parentArea <= 0.0f) parentArea = 1.0f;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        float extent = cMax[axis] - cMin[axis];
+        if (extent <= 0.0f) continue;
+
+        SAHBin bins[SAHBinCount];
+        float scale = SAHBinCount / extent;
+        for (int i = 0; i < node.count; ++i) {
+            int prim = primIndices[node.leftFirst + i];
+            int b = std::min(SAHBinCount - 1, static_cast<int>((primCentroid[prim][axis] - cMin[axis]) * scale));
+            bins[b].count++;
+            bins[b].bmin = glm::min(bins[b].bmin, primMin[prim]);
+            bins[b].bmax = glm::max(bins[b].bmax, primMax[prim]);
+        }
+
+        // 从左、从右两次扫描得到每个划分位置两侧的面积与数量
+        float leftArea[SAHBinCount - 1], rightArea[SAHBinCount - 1];
+        int leftCount[SAHBinCount - 1], rightCount[SAHBinCount - 1];
+        SAHBin leftBox, rightBox;
+        int leftSum = 0, rightSum = 0;
+        for (int i = 0; i < SAHBinCount - 1; ++i) {
+            leftSum += bins[i].count;
+            leftCount[i] = leftSum;
+            leftBox.bmin = glm::min(leftBox.bmin, bins[i].bmin);
+            leftBox.bmax = glm::max(leftBox.bmax, bins[i].bmax);
+            leftArea[i] = leftSum > 0 ? SurfaceArea(leftBox.bmin, leftBox.bmax) : 0.0f;
+
+            int r = SAHBinCount - 1 - i;
+            rightSum += bins[r].count;
+            rightCount[r - 1] = rightSum;
+            rightBox.bmin = glm::min(rightBox.bmin, bins[r].bmin);
+            rightBox.bmax = glm::max(rightBox.bmax, bins[r].bmax);
+            rightArea[r - 1] = rightSum > 0 ? SurfaceArea(rightBox.bmin, rightBox.bmax) : 0.0f;
+        }
+
+        for (int i = 0; i < SAHBinCount - 1; ++i) {
+            if (leftCount[i] == 0 || rightCount[i] == 0) continue;
+            float cost = TraversalCost +
+                         IntersectCost * (leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i]) / parentArea;
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestPos = cMin[axis] + (i + 1) / scale;
+            }
+        }
+    }
+    return bestCost;
+}
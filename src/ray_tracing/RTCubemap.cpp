@@ -0,0 +1,63 @@
+#include "RTCubemap.h"
+#include "RTKernels.h"
+#include <algorithm>
+
+namespace {
+    inline unsigned char ToByte(float c) {
+        return static_cast<unsigned char>(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+void RTCubemap::BuildFromEquirect(const RTMipTexture& equirect, int size, RTTextureLayout layout) {
+    Clear();
+    if (equirect.Empty()) return;
+    if (size <= 0) size = std::max(1, equirect.levels[0].width / 4);
+
+    // 面中心处一个纹素的张角；角落处纹素更小，取中心值即可避免混叠
+    float lod = RTMipLevelForAngle(equirect, static_cast<float>(M_PI / 2.0) / size);
+    float invSize = 1.0f / size;
+    RTTexture image;
+    image.width = image.height = size;
+    image.channels = 3;
+    image.data.resize(static_cast<size_t>(size) * size * 3);
+    for (int face = 0; face < CUBE_FACE_COUNT; ++face) {
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                glm::vec3 dir = glm::normalize(RTCubeToDirection(face, (x + 0.5f) * invSize, (y + 0.5f) * invSize));
+                float u, v;
+                RTDirectionToUV(dir, u, v);
+                glm::vec3 c = RTSampleMip(equirect, u, v, lod);
+                unsigned char* p = &image.data[(static_cast<size_t>(y) * size + x) * 3];
+                p[0] = ToByte(c.r);
+                p[1] = ToByte(c.g);
+                p[2] = ToByte(c.b);
+            }
+        }
+        faces[face].Build(image, layout);
+    }
+    faceSize = size;
+}
+
+bool RTCubemap::BuildFromFaces(const std::vector<RTTexture>& faceImages, RTTextureLayout layout) {
+    Clear();
+    if (faceImages.size() != CUBE_FACE_COUNT) return false;
+    int size = faceImages[0].width;
+    for (const RTTexture& image : faceImages) {
+        if (size <= 0 || image.width != size || image.height != size || image.channels <= 0 ||
+            image.data.size() < static_cast<size_t>(size) * size * image.channels) {
+            return false;
+        }
+    }
+    for (int face = 0; face < CUBE_FACE_COUNT; ++face) faces[face].Build(faceImages[face], layout);
+    faceSize = size;
+    return true;
+}
+
+void RTCubemap::SetLayout(RTTextureLayout layout) {
+    for (RTMipTexture& face : faces) face.SetLayout(layout);
+}
+
+void RTCubemap::Clear() {
+    faceSize = 0;
+    for (RTMipTexture& face : faces) face.Clear();
+}
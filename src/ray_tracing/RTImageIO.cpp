@@ -0,0 +1,145 @@
+#include "RTImageIO.h"
+#include <cstdio>
+#include <cstdint>
+#include <cctype>
+#include <algorithm>
+
+namespace {
+    uint32_t Crc32(uint32_t crc, const unsigned char* data, size_t size) {
+        static uint32_t table[256];
+        static bool tableReady = false;
+        if (!tableReady) {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                table[i] = c;
+            }
+            tableReady = true;
+        }
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    void PutU32BE(std::vector<unsigned char>& out, uint32_t v) {
+        out.push_back(static_cast<unsigned char>(v >> 24));
+        out.push_back(static_cast<unsigned char>(v >> 16));
+        out.push_back(static_cast<unsigned char>(v >> 8));
+        out.push_back(static_cast<unsigned char>(v));
+    }
+
+    void WriteChunk(FILE* f, const char* type, const std::vector<unsigned char>& payload) {
+        std::vector<unsigned char> chunk;
+        PutU32BE(chunk, static_cast<uint32_t>(payload.size()));
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), payload.begin(), payload.end());
+        // CRC 覆盖类型与数据，不包括长度
+        PutU32BE(chunk, Crc32(0, chunk.data() + 4, chunk.size() - 4));
+        fwrite(chunk.data(), 1, chunk.size(), f);
+    }
+
+    std::string LowerExtension(const std::string& path) {
+        size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos) return "";
+        std::string ext = path.substr(dot + 1);
+        for (char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return ext;
+    }
+}
+
+bool RTWritePPM(const std::string& path, int width, int height, const unsigned char* rgb) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    fprintf(f, "P6\n%d %d\n255\n", width, height);
+    size_t size = static_cast<size_t>(width) * height * 3;
+    bool ok = fwrite(rgb, 1, size, f) == size;
+    fclose(f);
+    return ok;
+}
+
+bool RTWritePNG(const std::string& path, int width, int height, const unsigned char* rgb) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(signature, 1, 8, f);
+
+    std::vector<unsigned char> header;
+    PutU32BE(header, static_cast<uint32_t>(width));
+    PutU32BE(header, static_cast<uint32_t>(height));
+    header.push_back(8);  // 位深
+    header.push_back(2);  // RGB
+    header.push_back(0);  // deflate
+    header.push_back(0);  // 自适应滤波
+    header.push_back(0);  // 不交错
+    WriteChunk(f, "IHDR", header);
+
+    // 每行前加滤波类型 0（None）
+    size_t rowBytes = static_cast<size_t>(width) * 3;
+    std::vector<unsigned char> raw;
+    raw.reserve((rowBytes + 1) * height);
+    for (int y = 0; y < height; ++y) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb + y * rowBytes, rgb + (y + 1) * rowBytes);
+    }
+
+    // zlib 流：头 + 存储块（每块最多 65535 字节）+ Adler-32
+    std::vector<unsigned char> zlib;
+    zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+    size_t pos = 0;
+    do {
+        size_t blockSize = std::min<size_t>(65535, raw.size() - pos);
+        bool last = (pos + blockSize == raw.size());
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(static_cast<unsigned char>(blockSize & 0xFF));
+        zlib.push_back(static_cast<unsigned char>(blockSize >> 8));
+        zlib.push_back(static_cast<unsigned char>(~blockSize & 0xFF));
+        zlib.push_back(static_cast<unsigned char>((~blockSize >> 8) & 0xFF));
+        zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + blockSize);
+        pos += blockSize;
+    } while (pos < raw.size());
+    uint32_t a = 1, b = 0;
+    for (unsigned char c : raw) {
+        a = (a + c) % 65521;
+        b = (b + a) % 65521;
+    }
+    PutU32BE(zlib, (b << 16) | a);
+    WriteChunk(f, "IDAT", zlib);
+
+    WriteChunk(f, "IEND", std::vector<unsigned char>());
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+bool RTWritePFM(const std::string& path, int width, int height, const std::vector<glm::vec3>& rgb) {
+    if (rgb.size() < static_cast<size_t>(width) * height) return false;
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    // 比例为负表示小端；PFM 的行从图像底部开始
+    fprintf(f, "PF\n%d %d\n-1.0\n", width, height);
+    bool ok = true;
+    for (int y = height - 1; y >= 0 && ok; --y) {
+        const glm::vec3* row = &rgb[static_cast<size_t>(y) * width];
+        ok = fwrite(row, sizeof(glm::vec3), width, f) == static_cast<size_t>(width);
+    }
+    fclose(f);
+    return ok;
+}
+
+bool RTWriteImage(const std::string& path, int width, int height,
+                  const unsigned char* rgb, const std::vector<glm::vec3>* hdr) {
+    std::string ext = LowerExtension(path);
+    if (ext == "png") return RTWritePNG(path, width, height, rgb);
+    if (ext == "pfm") {
+        if (hdr) return RTWritePFM(path, width, height, *hdr);
+        std::vector<glm::vec3> converted(static_cast<size_t>(width) * height);
+        for (size_t i = 0; i < converted.size(); ++i) {
+            converted[i] = glm::vec3(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]) / 255.0f;
+        }
+        return RTWritePFM(path, width, height, converted);
+    }
+    return RTWritePPM(path, width, height, rgb);
+}
@@ -0,0 +1,81 @@
+#include "RTLightList.h"
+#include <algorithm>
+
+namespace {
+    bool IsLightSphere(const RTSphereData& sphere, const std::vector<RTMaterial>& materials) {
+        int matIdx = sphere.materialIndex;
+        if (matIdx < 0 || matIdx >= static_cast<int>(materials.size())) return false;
+        return RTLightList::IsEmissive(materials[matIdx]);
+    }
+
+    RTLight MakeLight(int sphereIndex, const RTSphereData& sphere, const RTMaterial& material) {
+        RTLight light;
+        light.sphereIndex = sphereIndex;
+        light.center = sphere.center;
+        light.radius = sphere.radius;
+        light.emission = material.emission;
+        float luminance = glm::dot(material.emission, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+        light.power = std::max(luminance, 0.0f) * sphere.radius * sphere.radius;
+        return light;
+    }
+}
+
+void RTLightList::Build(const std::vector<RTSphereData>& spheres, const std::vector<RTMaterial>& materials) {
+    lights.clear();
+    sphereToLight.assign(spheres.size(), -1);
+    for (size_t i = 0; i < spheres.size(); ++i) {
+        if (!IsLightSphere(spheres[i], materials)) continue;
+        sphereToLight[i] = static_cast<int>(lights.size());
+        lights.push_back(MakeLight(static_cast<int>(i), spheres[i], materials[spheres[i].materialIndex]));
+    }
+    RebuildDistribution();
+}
+
+void RTLightList::Update(const std::vector<RTSphereData>& spheres, const std::vector<RTMaterial>& materials,
+                         const std::vector<int>& dirtySpheres) {
+    if (sphereToLight.size() != spheres.size()) {
+        Build(spheres, materials);
+        return;
+    }
+    bool changed = false;
+    for (int index : dirtySpheres) {
+        bool isLight = IsLightSphere(spheres[index], materials);
+        int lightIdx = sphereToLight[index];
+        if (isLight != (lightIdx >= 0)) {
+            Build(spheres, materials);
+            return;
+        }
+        if (lightIdx >= 0) {
+            lights[lightIdx] = MakeLight(index, spheres[index], materials[spheres[index].materialIndex]);
+            changed = true;
+        }
+    }
+    if (changed) RebuildDistribution();
+}
+
+void RTLightList::RebuildDistribution() {
+    cdf.resize(lights.size());
+    totalPower = 0.0f;
+    for (size_t i = 0; i < lights.size(); ++i) {
+        totalPower += lights[i].power;
+        cdf[i] = totalPower;
+    }
+    if (totalPower > 0.0f) {
+        for (float& c : cdf) c /= totalPower;
+    } else {
+        // 功率全为 0 时退化为均匀分布
+        for (size_t i = 0; i < cdf.size(); ++i) cdf[i] = static_cast<float>(i + 1) / cdf.size();
+    }
+    if (!cdf.empty()) cdf.back() = 1.0f;
+}
+
+int RTLightList::Sample(float u, float& pdf) const {
+    if (lights.empty()) {
+        pdf = 0.0f;
+        return -1;
+    }
+    int index = static_cast<int>(std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+    index = std::min(index, static_cast<int>(cdf.size()) - 1);
+    pdf = cdf[index] - (index > 0 ? cdf[index - 1] : 0.0f);
+    return index;
+}
@@ -0,0 +1,83 @@
+#include "RTMipmap.h"
+#include <algorithm>
+
+namespace {
+    inline uint32_t PackRGBA8(uint32_t r, uint32_t g, uint32_t b) {
+        return r | (g << 8) | (b << 16) | 0xff000000u;
+    }
+
+    // 2x2 盒式滤波（四舍五入）；奇数尺寸时下一级向上取整，最后一行 / 列与自身平均，不丢弃原图的边缘纹素
+    RTMipLevel Downsample(const RTMipLevel& src) {
+        RTMipLevel dst;
+        dst.width = (src.width + 1) / 2;
+        dst.height = (src.height + 1) / 2;
+        dst.texels.resize(static_cast<size_t>(dst.width) * dst.height);
+        for (int y = 0; y < dst.height; ++y) {
+            int y0 = std::min(2 * y, src.height - 1);
+            int y1 = std::min(2 * y + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x) {
+                int x0 = std::min(2 * x, src.width - 1);
+                int x1 = std::min(2 * x + 1, src.width - 1);
+                uint32_t t[4] = {src.texels[static_cast<size_t>(y0) * src.width + x0],
+                                 src.texels[static_cast<size_t>(y0) * src.width + x1],
+                                 src.texels[static_cast<size_t>(y1) * src.width + x0],
+                                 src.texels[static_cast<size_t>(y1) * src.width + x1]};
+                uint32_t sum[3] = {2, 2, 2};
+                for (uint32_t texel : t) {
+                    sum[0] += texel & 0xff;
+                    sum[1] += (texel >> 8) & 0xff;
+                    sum[2] += (texel >> 16) & 0xff;
+                }
+                dst.texels[static_cast<size_t>(y) * dst.width + x] = PackRGBA8(sum[0] / 4, sum[1] / 4, sum[2] / 4);
+            }
+        }
+        return dst;
+    }
+}
+
+void RTMipLevel::SetLayout(RTTextureLayout newLayout) {
+    if (newLayout == layout) return;
+    RTMipLevel converted;
+    converted.width = width;
+    converted.height = height;
+    converted.layout = newLayout;
+    if (newLayout == TEXTURE_LAYOUT_TILED) {
+        converted.tilesX = (width + TileSize - 1) / TileSize;
+        int tilesY = (height + TileSize - 1) / TileSize;
+        converted.texels.assign(static_cast<size_t>(converted.tilesX) * tilesY * TileSize * TileSize, 0u);
+    } else {
+        converted.texels.resize(static_cast<size_t>(width) * height);
+    }
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) converted.texels[converted.TexelIndex(x, y)] = Texel(x, y);
+    }
+    *this = std::move(converted);
+}
+
+void RTMipTexture::SetLayout(RTTextureLayout layout) {
+    for (RTMipLevel& level : levels) level.SetLayout(layout);
+}
+
+void RTMipTexture::Build(const RTTexture& tex, RTTextureLayout layout) {
+    levels.clear();
+    if (tex.width <= 0 || tex.height <= 0 || tex.channels <= 0 || tex.data.empty()) return;
+
+    // 第 0 级：通道映射与 RTSampleTexture 相同（单通道为灰度，双通道时 B 取 R）
+    RTMipLevel base;
+    base.width = tex.width;
+    base.height = tex.height;
+    base.texels.resize(static_cast<size_t>(tex.width) * tex.height);
+    for (size_t i = 0; i < base.texels.size(); ++i) {
+        const unsigned char* p = &tex.data[i * tex.channels];
+        uint32_t r = p[0];
+        uint32_t g = tex.channels > 1 ? p[1] : r;
+        uint32_t b = tex.channels > 2 ? p[2] : r;
+        base.texels[i] = PackRGBA8(r, g, b);
+    }
+    levels.push_back(std::move(base));
+
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        levels.push_back(Downsample(levels.back()));
+    }
+    SetLayout(layout);
+}
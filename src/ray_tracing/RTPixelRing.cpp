@@ -0,0 +1,134 @@
+#include "RTPixelRing.h"
+#include <glad.h>
+#include <glfw3.h>
+#include <cstring>
+
+// glad 只生成到 GL 4.3，glBufferStorage 需要手动加载
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+
+typedef void (APIENTRYP RTPFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+static RTPFNGLBUFFERSTORAGEPROC rtBufferStorage = nullptr;
+
+RTPixelRing::RTPixelRing() {
+    for (int i = 0; i < SlotCount; ++i) {
+        data[i] = nullptr;
+        pbo[i] = 0;
+        fence[i] = nullptr;
+    }
+}
+
+RTPixelRing::~RTPixelRing() {
+    Release();
+}
+
+bool RTPixelRing::LoadBufferStorage() {
+    // 核心版本 4.4 或 ARB_buffer_storage 扩展；仅凭函数地址不能判断（部分平台总是返回非空）
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool supported = (major > 4 || (major == 4 && minor >= 4));
+    if (!supported) {
+        GLint extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for (GLint i = 0; i < extensionCount && !supported; ++i) {
+            const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            supported = ext && std::strcmp(ext, "GL_ARB_buffer_storage") == 0;
+        }
+    }
+    if (!supported) return false;
+
+    if (!rtBufferStorage) rtBufferStorage = (RTPFNGLBUFFERSTORAGEPROC)glfwGetProcAddress("glBufferStorage");
+    return rtBufferStorage != nullptr;
+}
+
+void RTPixelRing::Init(size_t bytes, bool usePBO) {
+    Release();
+    capacity = bytes;
+    persistent = usePBO && LoadBufferStorage();
+
+    if (persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(SlotCount, pbo);
+        for (int i = 0; i < SlotCount; ++i) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[i]);
+            rtBufferStorage(GL_PIXEL_UNPACK_BUFFER, capacity, nullptr, flags);
+            data[i] = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, capacity, flags));
+            if (!data[i]) persistent = false;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (!persistent) {
+            Release(); // 映射失败，改用普通内存
+            capacity = bytes;
+        }
+    }
+
+    if (!persistent) {
+        for (int i = 0; i < SlotCount; ++i) {
+            fallback[i].assign(capacity, 0);
+            data[i] = fallback[i].data();
+        }
+    }
+}
+
+void RTPixelRing::Release() {
+    for (int i = 0; i < SlotCount; ++i) {
+        WaitSlotIdle(i);
+        if (pbo[i]) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[i]);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glDeleteBuffers(1, &pbo[i]);
+            pbo[i] = 0;
+        }
+        std::vector<unsigned char>().swap(fallback[i]);
+        data[i] = nullptr;
+    }
+    capacity = 0;
+    persistent = false;
+}
+
+bool RTPixelRing::IsSlotIdle(int slot) {
+    if (!fence[slot]) return true;
+    GLsync sync = static_cast<GLsync>(fence[slot]);
+    GLenum result = glClientWaitSync(sync, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) return false;
+    glDeleteSync(sync);
+    fence[slot] = nullptr;
+    return true;
+}
+
+void RTPixelRing::WaitSlotIdle(int slot) {
+    if (!fence[slot]) return;
+    GLsync sync = static_cast<GLsync>(fence[slot]);
+    // 第一次等待时刷新命令队列，确保围栏一定会被执行
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true) {
+        GLenum result = glClientWaitSync(sync, flags, 1000000); // 1 ms
+        if (result != GL_TIMEOUT_EXPIRED) break;
+        flags = 0;
+    }
+    glDeleteSync(sync);
+    fence[slot] = nullptr;
+}
+
+void RTPixelRing::Upload(int slot, unsigned int texture, int w, int h) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // 行宽不一定是 4 的倍数
+    if (persistent) {
+        // 数据源是 PBO，驱动可以异步完成拷贝；一致映射下 CPU 写入对 GPU 直接可见
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[slot]);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        fence[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, data[slot]);
+    }
+}
@@ -0,0 +1,136 @@
+#include "RTPresenter.h"
+#include <glad.h>
+#include <glfw3.h>
+
+// 简单的顶点着色器：绘制全屏四边形
+const char* screenVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoords;
+
+out vec2 TexCoords;
+
+void main()
+{
+    TexCoords = aTexCoords;
+    gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0); 
+}
+)";
+
+// 简单的片段着色器：显示纹理
+// 追踪结果只占纹理左下角 uvScale 的区域，双线性放大到全屏；uvMax 防止采样到区域外的旧数据
+const char* screenFragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+in vec2 TexCoords;
+uniform sampler2D screenTexture;
+uniform vec2 uvScale;
+uniform vec2 uvMax;
+void main()
+{
+    FragColor = texture(screenTexture, min(TexCoords * uvScale, uvMax));
+}
+)";
+
+RTPresenter::RTPresenter(int w, int h) : width(w), height(h), displayWidth(w), displayHeight(h) {
+    InitGLResources();
+}
+
+RTPresenter::~RTPresenter() {
+    pixelRing.Release(); // 先等 GPU 读完再删除纹理
+    if (textureID) glDeleteTextures(1, &textureID);
+    if (quadVAO) glDeleteVertexArrays(1, &quadVAO);
+    if (quadVBO) glDeleteBuffers(1, &quadVBO);
+    if (screenShaderProgram) glDeleteProgram(screenShaderProgram);
+}
+
+void RTPresenter::Resize(int w, int h) {
+    if (w == width && h == height && pixelRing.GetCapacity() > 0) return;
+    width = w;
+    height = h;
+    displayWidth = displayHeight = 0;
+
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+    pixelRing.Init(static_cast<size_t>(width) * height * 3, true);
+}
+
+void RTPresenter::Present(int slot, int w, int h) {
+    // 更新纹理左下角的追踪区域；PBO 模式下拷贝由 GPU 异步完成
+    pixelRing.Upload(slot, textureID, w, h);
+    displayWidth = w;
+    displayHeight = h;
+}
+
+void RTPresenter::InitGLResources() {
+    // 创建纹理
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // 追踪结果的输出缓冲（按窗口分辨率分配，动态分辨率下只使用其中一部分）
+    pixelRing.Init(static_cast<size_t>(width) * height * 3, true);
+
+    // 创建全屏四边形
+    float quadVertices[] = { 
+        // positions   // texCoords
+        -1.0f,  1.0f,  0.0f, 1.0f,
+        -1.0f, -1.0f,  0.0f, 0.0f,
+         1.0f, -1.0f,  1.0f, 0.0f,
+
+        -1.0f,  1.0f,  0.0f, 1.0f,
+         1.0f, -1.0f,  1.0f, 0.0f,
+         1.0f,  1.0f,  1.0f, 1.0f
+    };
+
+    glGenVertexArrays(1, &quadVAO);
+    glGenBuffers(1, &quadVBO);
+    glBindVertexArray(quadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+
+    SetupScreenShader();
+}
+
+void RTPresenter::SetupScreenShader() {
+    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &screenVertexShaderSource, NULL);
+    glCompileShader(vertexShader);
+    // Check errors...
+
+    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &screenFragmentShaderSource, NULL);
+    glCompileShader(fragmentShader);
+    // Check errors...
+
+    screenShaderProgram = glCreateProgram();
+    glAttachShader(screenShaderProgram, vertexShader);
+    glAttachShader(screenShaderProgram, fragmentShader);
+    glLinkProgram(screenShaderProgram);
+    
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    uvScaleLocation = glGetUniformLocation(screenShaderProgram, "uvScale");
+    uvMaxLocation = glGetUniformLocation(screenShaderProgram, "uvMax");
+}
+
+void RTPresenter::Draw() {
+    glUseProgram(screenShaderProgram);
+    // 只采样纹理中实际追踪的区域，由双线性过滤放大到全屏
+    float su = static_cast<float>(displayWidth) / width;
+    float sv = static_cast<float>(displayHeight) / height;
+    glUniform2f(uvScaleLocation, su, sv);
+    glUniform2f(uvMaxLocation, (displayWidth - 0.5f) / width, (displayHeight - 0.5f) / height);
+    glBindVertexArray(quadVAO);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
@@ -0,0 +1,169 @@
+#include "RTScene.h"
+#include <cstring>
+#include <algorithm>
+
+namespace {
+    bool SameMaterial(const RTMaterial& a, const RTMaterial& b) {
+        return a.color == b.color && a.emission == b.emission && a.type == b.type &&
+               a.roughness == b.roughness && a.ior == b.ior;
+    }
+}
+
+RTMaterialHandle RTScene::AddMaterial(const RTMaterial& material, RTTextureHandle texture) {
+    materials.push_back(material);
+    materialTextures.push_back(texture);
+    dirtyFlags |= DIRTY_MATERIALS;
+    return static_cast<RTMaterialHandle>(materials.size() - 1);
+}
+
+void RTScene::UpdateMaterial(RTMaterialHandle handle, const RTMaterial& material) {
+    if (handle < 0 || handle >= static_cast<int>(materials.size())) return;
+    if (SameMaterial(materials[handle], material)) return;
+    materials[handle] = material;
+    dirtyFlags |= DIRTY_MATERIALS;
+}
+
+void RTScene::UpdateMaterialTexture(RTMaterialHandle handle, RTTextureHandle texture) {
+    if (handle < 0 || handle >= static_cast<int>(materials.size())) return;
+    if (materialTextures[handle] == texture) return;
+    materialTextures[handle] = texture;
+    dirtyFlags |= DIRTY_MATERIALS;
+}
+
+RTSphereHandle RTScene::AddSphere(const glm::vec3& center, float radius, RTMaterialHandle material) {
+    RTSphereData data;
+    std::memset(&data, 0, sizeof(data));
+    data.center = center;
+    data.radius = radius;
+    data.materialIndex = material;
+
+    RTSphereHandle handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    } else {
+        handle = static_cast<RTSphereHandle>(handleToIndex.size());
+        handleToIndex.push_back(-1);
+    }
+    handleToIndex[handle] = static_cast<int>(spheres.size());
+    indexToHandle.push_back(handle);
+    spheres.push_back(data);
+    sphereDirty.push_back(0);
+    dirtyFlags |= DIRTY_TOPOLOGY;
+    return handle;
+}
+
+bool RTScene::IsValid(RTSphereHandle handle) const {
+    return handle >= 0 && handle < static_cast<int>(handleToIndex.size()) && handleToIndex[handle] >= 0;
+}
+
+void RTScene::MarkSphereDirty(int index) {
+    dirtyFlags |= DIRTY_SPHERES;
+    if (!sphereDirty[index]) {
+        sphereDirty[index] = 1;
+        dirtySpheres.push_back(index);
+    }
+}
+
+void RTScene::SetSphereAt(int index, const glm::vec3& center, float radius, RTMaterialHandle material) {
+    RTSphereData& data = spheres[index];
+    if (data.center == center && data.radius == radius && data.materialIndex == material) return;
+    data.center = center;
+    data.radius = radius;
+    data.materialIndex = material;
+    MarkSphereDirty(index);
+}
+
+void RTScene::UpdateSphere(RTSphereHandle handle, const glm::vec3& center, float radius) {
+    if (!IsValid(handle)) return;
+    int index = handleToIndex[handle];
+    SetSphereAt(index, center, radius, spheres[index].materialIndex);
+}
+
+void RTScene::SetSphereMaterial(RTSphereHandle handle, RTMaterialHandle material) {
+    if (!IsValid(handle)) return;
+    int index = handleToIndex[handle];
+    SetSphereAt(index, spheres[index].center, spheres[index].radius, material);
+}
+
+void RTScene::RemoveSphere(RTSphereHandle handle) {
+    if (!IsValid(handle)) return;
+    // 用最后一个球体填补空位，保持数组紧凑
+    int index = handleToIndex[handle];
+    int last = static_cast<int>(spheres.size()) - 1;
+    // 待更新列表跟随下标变化：被删除的球体移出列表，最后一个球体的下标改为 index，
+    // 否则 ClearDirty 清不掉它的脏位，之后的 UpdateSphere 不会再把它加入列表
+    if (sphereDirty[index]) dirtySpheres.erase(std::remove(dirtySpheres.begin(), dirtySpheres.end(), index), dirtySpheres.end());
+    if (index != last && sphereDirty[last]) std::replace(dirtySpheres.begin(), dirtySpheres.end(), last, index);
+    if (index != last) {
+        spheres[index] = spheres[last];
+        sphereDirty[index] = sphereDirty[last];
+        indexToHandle[index] = indexToHandle[last];
+        handleToIndex[indexToHandle[index]] = index;
+    }
+    spheres.pop_back();
+    sphereDirty.pop_back();
+    indexToHandle.pop_back();
+    handleToIndex[handle] = -1;
+    freeHandles.push_back(handle);
+    dirtyFlags |= DIRTY_TOPOLOGY;
+}
+
+void RTScene::Assign(const std::vector<RTSphereData>& newSpheres,
+                     const std::vector<RTMaterial>& newMaterials,
+                     const std::vector<RTTextureHandle>& newMaterialTextures) {
+    // 材质
+    if (materials.size() != newMaterials.size()) {
+        materials = newMaterials;
+        dirtyFlags |= DIRTY_MATERIALS;
+    } else {
+        for (size_t i = 0; i < newMaterials.size(); ++i) {
+            UpdateMaterial(static_cast<RTMaterialHandle>(i), newMaterials[i]);
+        }
+    }
+    std::vector<RTTextureHandle> textures(materials.size(), RT_INVALID_TEXTURE);
+    for (size_t i = 0; i < textures.size() && i < newMaterialTextures.size(); ++i) {
+        textures[i] = newMaterialTextures[i];
+    }
+    if (textures != materialTextures) {
+        materialTextures.swap(textures);
+        dirtyFlags |= DIRTY_MATERIALS;
+    }
+
+    // 球体：数量不变时按下标逐个比较
+    if (spheres.size() != newSpheres.size()) {
+        spheres.clear();
+        handleToIndex.clear();
+        indexToHandle.clear();
+        freeHandles.clear();
+        sphereDirty.clear();
+        dirtySpheres.clear();
+        for (const RTSphereData& s : newSpheres) {
+            AddSphere(s.center, s.radius, s.materialIndex);
+        }
+        return;
+    }
+    for (size_t i = 0; i < newSpheres.size(); ++i) {
+        SetSphereAt(static_cast<int>(i), newSpheres[i].center, newSpheres[i].radius, newSpheres[i].materialIndex);
+    }
+}
+
+void RTScene::Clear() {
+    spheres.clear();
+    materials.clear();
+    materialTextures.clear();
+    handleToIndex.clear();
+    indexToHandle.clear();
+    freeHandles.clear();
+    sphereDirty.clear();
+    dirtySpheres.clear();
+    dirtyFlags = DIRTY_TOPOLOGY | DIRTY_MATERIALS;
+}
+
+void RTScene::ClearDirty() {
+    for (int index : dirtySpheres) {
+        if (index < static_cast<int>(sphereDirty.size())) sphereDirty[index] = 0;
+    }
+    dirtySpheres.clear();
+    dirtyFlags = DIRTY_NONE;
+}
@@ -0,0 +1,395 @@
+#include "RTSimd.h"
+#include "RTFastMath.h"
+#include "RTCubemap.h"
+#include <cmath>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RT_SIMD_X86 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#ifdef RT_HAVE_AVX2
+// 定义在 RTSimdAVX2.cpp（单独以 AVX2 指令集编译）
+void RTClosestHitAVX2(const RTSphereSoA& soa, int first, int count,
+                      const glm::vec3& origin, const glm::vec3& dir, float& tMax, int& hitSphere);
+bool RTAnyHitAVX2(const RTSphereSoA& soa, int first, int count,
+                  const glm::vec3& origin, const glm::vec3& dir, float tMax, int skipA, int skipB);
+void RTPacketClosestHitAVX2(const RTSphereSoA& soa, const int* candidates, int candidateCount, RTRayPacket& packet);
+void RTDirectionToUVAVX2(const float* x, const float* y, const float* z, int count, float* u, float* v);
+void RTDirectionToCubeAVX2(const float* x, const float* y, const float* z, int count, int* face, float* s, float* t);
+#endif
+
+void RTSphereSoA::Build(const std::vector<RTSphereData>& spheres, const std::vector<int>& order) {
+    count = static_cast<int>(order.size());
+    int padded = count + Padding;
+    centerX.resize(padded);
+    centerY.resize(padded);
+    centerZ.resize(padded);
+    radius2.resize(padded);
+    materialIndex.resize(padded);
+    sphereIndex.resize(padded);
+    position.resize(count);
+    for (int i = 0; i < count; ++i) {
+        const RTSphereData& s = spheres[order[i]];
+        centerX[i] = s.center.x;
+        centerY[i] = s.center.y;
+        centerZ[i] = s.center.z;
+        radius2[i] = s.radius * s.radius;
+        materialIndex[i] = s.materialIndex;
+        sphereIndex[i] = order[i];
+        position[order[i]] = i;
+    }
+    // 填充项：半径平方为负，永远不会命中
+    for (int i = count; i < padded; ++i) {
+        centerX[i] = centerY[i] = centerZ[i] = 0.0f;
+        radius2[i] = -1.0f;
+        materialIndex[i] = -1;
+        sphereIndex[i] = -1;
+    }
+}
+
+void RTSphereSoA::Update(const std::vector<RTSphereData>& spheres, const std::vector<int>& dirtySpheres) {
+    for (int index : dirtySpheres) {
+        int i = position[index];
+        const RTSphereData& s = spheres[index];
+        centerX[i] = s.center.x;
+        centerY[i] = s.center.y;
+        centerZ[i] = s.center.z;
+        radius2[i] = s.radius * s.radius;
+        materialIndex[i] = s.materialIndex;
+    }
+}
+
+void RTRayPacket::Set(int i, const glm::vec3& dir, float t, int hit) {
+    dirX[i] = dir.x;
+    dirY[i] = dir.y;
+    dirZ[i] = dir.z;
+    dirDot[i] = glm::dot(dir, dir);
+    tMax[i] = t;
+    hitSphere[i] = hit;
+}
+
+void RTRayPacket::Pad() {
+    if (count <= 0) return;
+    int padded = std::min((count + 7) & ~7, MaxRays);
+    for (int i = count; i < padded; ++i) {
+        dirX[i] = dirX[count - 1];
+        dirY[i] = dirY[count - 1];
+        dirZ[i] = dirZ[count - 1];
+        dirDot[i] = dirDot[count - 1];
+        tMax[i] = tMax[count - 1];
+        hitSphere[i] = hitSphere[count - 1];
+    }
+}
+
+namespace {
+
+// 与 RTIntersectSphere（RTKernels.h）完全相同的运算顺序，保证各指令集结果逐位一致
+inline bool IntersectSoA(const RTSphereSoA& soa, int i, const glm::vec3& origin, const glm::vec3& dir, float a, float& t) {
+    float ocx = origin.x - soa.centerX[i];
+    float ocy = origin.y - soa.centerY[i];
+    float ocz = origin.z - soa.centerZ[i];
+    float b = 2.0f * (ocx * dir.x + ocy * dir.y + ocz * dir.z);
+    float c = (ocx * ocx + ocy * ocy + ocz * ocz) - soa.radius2[i];
+    float discriminant = b * b - 4 * a * c;
+    if (discriminant < 0) return false;
+    float sq = std::sqrt(discriminant);
+    float t1 = (-b - sq) / (2.0f * a);
+    if (t1 > 0.001f) { t = t1; return true; }
+    float t2 = (-b + sq) / (2.0f * a);
+    if (t2 > 0.001f) { t = t2; return true; }
+    return false;
+}
+
+void ClosestHitScalar(const RTSphereSoA& soa, int first, int count,
+                      const glm::vec3& origin, const glm::vec3& dir, float& tMax, int& hitSphere) {
+    float a = glm::dot(dir, dir);
+    for (int i = first; i < first + count; ++i) {
+        float t;
+        if (IntersectSoA(soa, i, origin, dir, a, t)) {
+            int id = soa.sphereIndex[i];
+            if (t < tMax || (t == tMax && id < hitSphere)) {
+                tMax = t;
+                hitSphere = id;
+            }
+        }
+    }
+}
+
+void PacketClosestHitScalar(const RTSphereSoA& soa, const int* candidates, int candidateCount, RTRayPacket& packet) {
+    for (int r = 0; r < packet.count; ++r) {
+        glm::vec3 dir(packet.dirX[r], packet.dirY[r], packet.dirZ[r]);
+        float a = packet.dirDot[r];
+        for (int c = 0; c < candidateCount; ++c) {
+            int i = candidates[c];
+            float t;
+            if (IntersectSoA(soa, i, packet.origin, dir, a, t)) {
+                int id = soa.sphereIndex[i];
+                if (t < packet.tMax[r] || (t == packet.tMax[r] && id < packet.hitSphere[r])) {
+                    packet.tMax[r] = t;
+                    packet.hitSphere[r] = id;
+                }
+            }
+        }
+    }
+}
+
+bool AnyHitScalar(const RTSphereSoA& soa, int first, int count,
+                  const glm::vec3& origin, const glm::vec3& dir, float tMax, int skipA, int skipB) {
+    float a = glm::dot(dir, dir);
+    for (int i = first; i < first + count; ++i) {
+        int id = soa.sphereIndex[i];
+        if (id == skipA || id == skipB) continue;
+        float t;
+        if (IntersectSoA(soa, i, origin, dir, a, t) && t < tMax) return true;
+    }
+    return false;
+}
+
+void DirectionToUVScalar(const float* x, const float* y, const float* z, int count, float* u, float* v) {
+    for (int i = 0; i < count; ++i) RTFastDirectionToUV(x[i], y[i], z[i], u[i], v[i]);
+}
+
+void DirectionToCubeScalar(const float* x, const float* y, const float* z, int count, int* face, float* s, float* t) {
+    for (int i = 0; i < count; ++i) face[i] = RTDirectionToCube(x[i], y[i], z[i], s[i], t[i]);
+}
+
+#ifdef RT_SIMD_X86
+// 4 路 SSE：一次测试 4 个球体，返回 t 值与命中掩码（位 k 对应第 k 个球体）
+inline int IntersectSSE(const RTSphereSoA& soa, int i, __m128 ox, __m128 oy, __m128 oz,
+                        __m128 dx, __m128 dy, __m128 dz, __m128 twoA, __m128 fourA, float* tOut) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 eps = _mm_set1_ps(0.001f);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    __m128 ocx = _mm_sub_ps(ox, _mm_loadu_ps(&soa.centerX[i]));
+    __m128 ocy = _mm_sub_ps(oy, _mm_loadu_ps(&soa.centerY[i]));
+    __m128 ocz = _mm_sub_ps(oz, _mm_loadu_ps(&soa.centerZ[i]));
+    __m128 b = _mm_mul_ps(two, _mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, dx), _mm_mul_ps(ocy, dy)), _mm_mul_ps(ocz, dz)));
+    __m128 c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, ocx), _mm_mul_ps(ocy, ocy)), _mm_mul_ps(ocz, ocz)),
+                          _mm_loadu_ps(&soa.radius2[i]));
+    __m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(fourA, c));
+    __m128 hasRoot = _mm_cmpge_ps(disc, zero);
+
+    __m128 sq = _mm_sqrt_ps(_mm_max_ps(disc, zero));
+    __m128 negB = _mm_xor_ps(b, signBit);
+    __m128 t1 = _mm_div_ps(_mm_sub_ps(negB, sq), twoA);
+    __m128 t2 = _mm_div_ps(_mm_add_ps(negB, sq), twoA);
+    __m128 useT1 = _mm_cmpgt_ps(t1, eps);
+    __m128 t = _mm_or_ps(_mm_and_ps(useT1, t1), _mm_andnot_ps(useT1, t2));
+    __m128 hit = _mm_and_ps(hasRoot, _mm_cmpgt_ps(t, eps));
+
+    _mm_storeu_ps(tOut, t);
+    return _mm_movemask_ps(hit);
+}
+
+void ClosestHitSSE(const RTSphereSoA& soa, int first, int count,
+                   const glm::vec3& origin, const glm::vec3& dir, float& tMax, int& hitSphere) {
+    float a = glm::dot(dir, dir);
+    __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+    __m128 dx = _mm_set1_ps(dir.x), dy = _mm_set1_ps(dir.y), dz = _mm_set1_ps(dir.z);
+    __m128 twoA = _mm_set1_ps(2.0f * a), fourA = _mm_set1_ps(4 * a);
+    float t[4];
+    int end = first + count;
+    for (int i = first; i < end; i += 4) {
+        int mask = IntersectSSE(soa, i, ox, oy, oz, dx, dy, dz, twoA, fourA, t);
+        if (end - i < 4) mask &= (1 << (end - i)) - 1;
+        while (mask) {
+            int k = 0;
+            while (!(mask & (1 << k))) ++k;
+            mask &= ~(1 << k);
+            int id = soa.sphereIndex[i + k];
+            if (t[k] < tMax || (t[k] == tMax && id < hitSphere)) {
+                tMax = t[k];
+                hitSphere = id;
+            }
+        }
+    }
+}
+
+bool AnyHitSSE(const RTSphereSoA& soa, int first, int count,
+               const glm::vec3& origin, const glm::vec3& dir, float tMax, int skipA, int skipB) {
+    float a = glm::dot(dir, dir);
+    __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+    __m128 dx = _mm_set1_ps(dir.x), dy = _mm_set1_ps(dir.y), dz = _mm_set1_ps(dir.z);
+    __m128 twoA = _mm_set1_ps(2.0f * a), fourA = _mm_set1_ps(4 * a);
+    float t[4];
+    int end = first + count;
+    for (int i = first; i < end; i += 4) {
+        int mask = IntersectSSE(soa, i, ox, oy, oz, dx, dy, dz, twoA, fourA, t);
+        if (end - i < 4) mask &= (1 << (end - i)) - 1;
+        for (int k = 0; k < 4; ++k) {
+            if (!(mask & (1 << k))) continue;
+            int id = soa.sphereIndex[i + k];
+            if (id != skipA && id != skipB && t[k] < tMax) return true;
+        }
+    }
+    return false;
+}
+
+// 光线包：每次取 4 条光线，对每个候选球体做一次 4 路测试；球体数据广播到各通道，
+// 各通道的运算与 IntersectSSE 相同
+void PacketClosestHitSSE(const RTSphereSoA& soa, const int* candidates, int candidateCount, RTRayPacket& packet) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 four = _mm_set1_ps(4.0f);
+    const __m128 eps = _mm_set1_ps(0.001f);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    __m128 ox = _mm_set1_ps(packet.origin.x), oy = _mm_set1_ps(packet.origin.y), oz = _mm_set1_ps(packet.origin.z);
+
+    for (int r = 0; r < packet.count; r += 4) {
+        __m128 dx = _mm_loadu_ps(&packet.dirX[r]);
+        __m128 dy = _mm_loadu_ps(&packet.dirY[r]);
+        __m128 dz = _mm_loadu_ps(&packet.dirZ[r]);
+        __m128 a = _mm_loadu_ps(&packet.dirDot[r]);
+        __m128 twoA = _mm_mul_ps(two, a), fourA = _mm_mul_ps(four, a);
+        __m128 tMax = _mm_loadu_ps(&packet.tMax[r]);
+        __m128i hitSphere = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&packet.hitSphere[r]));
+
+        for (int c = 0; c < candidateCount; ++c) {
+            int i = candidates[c];
+            __m128 ocx = _mm_sub_ps(ox, _mm_set1_ps(soa.centerX[i]));
+            __m128 ocy = _mm_sub_ps(oy, _mm_set1_ps(soa.centerY[i]));
+            __m128 ocz = _mm_sub_ps(oz, _mm_set1_ps(soa.centerZ[i]));
+            __m128 b = _mm_mul_ps(two, _mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, dx), _mm_mul_ps(ocy, dy)), _mm_mul_ps(ocz, dz)));
+            __m128 cc = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, ocx), _mm_mul_ps(ocy, ocy)), _mm_mul_ps(ocz, ocz)),
+                                   _mm_set1_ps(soa.radius2[i]));
+            __m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(fourA, cc));
+            __m128 hasRoot = _mm_cmpge_ps(disc, zero);
+            if (!_mm_movemask_ps(hasRoot)) continue;
+
+            __m128 sq = _mm_sqrt_ps(_mm_max_ps(disc, zero));
+            __m128 negB = _mm_xor_ps(b, signBit);
+            __m128 t1 = _mm_div_ps(_mm_sub_ps(negB, sq), twoA);
+            __m128 t2 = _mm_div_ps(_mm_add_ps(negB, sq), twoA);
+            __m128 useT1 = _mm_cmpgt_ps(t1, eps);
+            __m128 t = _mm_or_ps(_mm_and_ps(useT1, t1), _mm_andnot_ps(useT1, t2));
+            __m128 hit = _mm_and_ps(hasRoot, _mm_cmpgt_ps(t, eps));
+
+            // 更近，或距离相同且原始下标更小
+            __m128i id = _mm_set1_epi32(soa.sphereIndex[i]);
+            __m128 smallerId = _mm_castsi128_ps(_mm_cmplt_epi32(id, hitSphere));
+            __m128 closer = _mm_and_ps(hit, _mm_or_ps(_mm_cmplt_ps(t, tMax),
+                                                      _mm_and_ps(_mm_cmpeq_ps(t, tMax), smallerId)));
+            tMax = _mm_or_ps(_mm_and_ps(closer, t), _mm_andnot_ps(closer, tMax));
+            __m128i closerI = _mm_castps_si128(closer);
+            hitSphere = _mm_or_si128(_mm_and_si128(closerI, id), _mm_andnot_si128(closerI, hitSphere));
+        }
+        _mm_storeu_ps(&packet.tMax[r], tMax);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&packet.hitSphere[r]), hitSphere);
+    }
+}
+
+// 每次 4 个方向，不足 4 个的尾部用标量版本
+void DirectionToUVSSE(const float* x, const float* y, const float* z, int count, float* u, float* v) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 invTwoPi = _mm_set1_ps(RTFastMathConst::InvTwoPi);
+    const __m128 invPi = _mm_set1_ps(RTFastMathConst::InvPi);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 atan = RTFastAtan2SSE(_mm_loadu_ps(z + i), _mm_loadu_ps(x + i));
+        __m128 asin = RTFastAsinSSE(_mm_loadu_ps(y + i));
+        _mm_storeu_ps(u + i, _mm_add_ps(half, _mm_mul_ps(atan, invTwoPi)));
+        _mm_storeu_ps(v + i, _mm_sub_ps(half, _mm_mul_ps(asin, invPi)));
+    }
+    DirectionToUVScalar(x + i, y + i, z + i, count - i, u + i, v + i);
+}
+
+// 每次 4 个方向：三个主轴的结果都算出后按掩码选择，分支与 RTDirectionToCube 相同
+void DirectionToCubeSSE(const float* x, const float* y, const float* z, int count, int* face, float* s, float* t) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+        __m128 ax = _mm_andnot_ps(signBit, vx), ay = _mm_andnot_ps(signBit, vy), az = _mm_andnot_ps(signBit, vz);
+        __m128 majorX = _mm_and_ps(_mm_cmpge_ps(ax, ay), _mm_cmpge_ps(ax, az));
+        __m128 majorY = _mm_cmpge_ps(ay, az); // 只在非 majorX 的通道使用
+        __m128 negX = _mm_cmplt_ps(vx, zero), negY = _mm_cmplt_ps(vy, zero), negZ = _mm_cmplt_ps(vz, zero);
+        __m128 mx = _mm_xor_ps(vx, signBit), my = _mm_xor_ps(vy, signBit), mz = _mm_xor_ps(vz, signBit);
+
+        __m128 ma = RTSelectSSE(majorX, ax, RTSelectSSE(majorY, ay, az));
+        __m128 sc = RTSelectSSE(majorX, RTSelectSSE(negX, vz, mz), RTSelectSSE(majorY, vx, RTSelectSSE(negZ, mx, vx)));
+        __m128 tc = RTSelectSSE(majorX, my, RTSelectSSE(majorY, RTSelectSSE(negY, mz, vz), my));
+        __m128 f = RTSelectSSE(majorX, _mm_and_ps(negX, one),
+                               RTSelectSSE(majorY, _mm_add_ps(_mm_set1_ps(2.0f), _mm_and_ps(negY, one)),
+                                           _mm_add_ps(_mm_set1_ps(4.0f), _mm_and_ps(negZ, one))));
+        __m128 scale = _mm_div_ps(half, ma);
+        _mm_storeu_ps(s + i, _mm_add_ps(_mm_mul_ps(sc, scale), half));
+        _mm_storeu_ps(t + i, _mm_add_ps(_mm_mul_ps(tc, scale), half));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(face + i), _mm_cvttps_epi32(f));
+    }
+    DirectionToCubeScalar(x + i, y + i, z + i, count - i, face + i, s + i, t + i);
+}
+#endif
+
+bool CpuSupportsAVX2() {
+#if defined(RT_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(RT_SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false; // 操作系统需保存 YMM 寄存器
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+RTSimdLevel RTDetectSimdLevel() {
+#ifdef RT_HAVE_AVX2
+    static const bool avx2 = CpuSupportsAVX2();
+    if (avx2) return SIMD_AVX2;
+#endif
+#ifdef RT_SIMD_X86
+    return SIMD_SSE; // x86-64 基线指令集
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+RTSimdKernels RTGetSimdKernels(RTSimdLevel level) {
+    RTSimdLevel best = RTDetectSimdLevel();
+    if (level == SIMD_AUTO || level > best) level = best;
+
+    switch (level) {
+#ifdef RT_HAVE_AVX2
+    case SIMD_AVX2:
+        return {SIMD_AVX2, RTClosestHitAVX2, RTAnyHitAVX2, RTPacketClosestHitAVX2, RTDirectionToUVAVX2,
+                RTDirectionToCubeAVX2};
+#endif
+#ifdef RT_SIMD_X86
+    case SIMD_SSE:
+        return {SIMD_SSE, ClosestHitSSE, AnyHitSSE, PacketClosestHitSSE, DirectionToUVSSE, DirectionToCubeSSE};
+#endif
+    default:
+        return {SIMD_SCALAR, ClosestHitScalar, AnyHitScalar, PacketClosestHitScalar, DirectionToUVScalar,
+                DirectionToCubeScalar};
+    }
+}
+
+const char* RTSimdLevelName(RTSimdLevel level) {
+    switch (level) {
+    case SIMD_AUTO: return "auto";
+    case SIMD_SCALAR: return "scalar";
+    case SIMD_SSE: return "sse";
+    case SIMD_AVX2: return "avx2";
+    }
+    return "unknown";
+}
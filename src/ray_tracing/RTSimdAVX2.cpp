@@ -0,0 +1,188 @@
+// 本文件单独以 AVX2 指令集编译（见 CMakeLists.txt），仅在运行时检测到 AVX2 后才会被调用
+#include "RTSimd.h"
+#include "RTFastMath.h"
+#include "RTCubemap.h"
+
+#ifdef RT_HAVE_AVX2
+#include <immintrin.h>
+
+namespace {
+
+// 8 路：一次测试 8 个球体，运算顺序与标量版本一致
+inline int IntersectAVX2(const RTSphereSoA& soa, int i, __m256 ox, __m256 oy, __m256 oz,
+                         __m256 dx, __m256 dy, __m256 dz, __m256 twoA, __m256 fourA, float* tOut) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 eps = _mm256_set1_ps(0.001f);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    __m256 ocx = _mm256_sub_ps(ox, _mm256_loadu_ps(&soa.centerX[i]));
+    __m256 ocy = _mm256_sub_ps(oy, _mm256_loadu_ps(&soa.centerY[i]));
+    __m256 ocz = _mm256_sub_ps(oz, _mm256_loadu_ps(&soa.centerZ[i]));
+    __m256 b = _mm256_mul_ps(two, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocx, dx), _mm256_mul_ps(ocy, dy)),
+                                                _mm256_mul_ps(ocz, dz)));
+    __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocx, ocx), _mm256_mul_ps(ocy, ocy)),
+                                           _mm256_mul_ps(ocz, ocz)),
+                             _mm256_loadu_ps(&soa.radius2[i]));
+    __m256 disc = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(fourA, c));
+    __m256 hasRoot = _mm256_cmp_ps(disc, zero, _CMP_GE_OQ);
+
+    __m256 sq = _mm256_sqrt_ps(_mm256_max_ps(disc, zero));
+    __m256 negB = _mm256_xor_ps(b, signBit);
+    __m256 t1 = _mm256_div_ps(_mm256_sub_ps(negB, sq), twoA);
+    __m256 t2 = _mm256_div_ps(_mm256_add_ps(negB, sq), twoA);
+    __m256 t = _mm256_blendv_ps(t2, t1, _mm256_cmp_ps(t1, eps, _CMP_GT_OQ));
+    __m256 hit = _mm256_and_ps(hasRoot, _mm256_cmp_ps(t, eps, _CMP_GT_OQ));
+
+    _mm256_storeu_ps(tOut, t);
+    return _mm256_movemask_ps(hit);
+}
+
+} // namespace
+
+void RTClosestHitAVX2(const RTSphereSoA& soa, int first, int count,
+                      const glm::vec3& origin, const glm::vec3& dir, float& tMax, int& hitSphere) {
+    float a = glm::dot(dir, dir);
+    __m256 ox = _mm256_set1_ps(origin.x), oy = _mm256_set1_ps(origin.y), oz = _mm256_set1_ps(origin.z);
+    __m256 dx = _mm256_set1_ps(dir.x), dy = _mm256_set1_ps(dir.y), dz = _mm256_set1_ps(dir.z);
+    __m256 twoA = _mm256_set1_ps(2.0f * a), fourA = _mm256_set1_ps(4 * a);
+    float t[8];
+    int end = first + count;
+    for (int i = first; i < end; i += 8) {
+        int mask = IntersectAVX2(soa, i, ox, oy, oz, dx, dy, dz, twoA, fourA, t);
+        if (end - i < 8) mask &= (1 << (end - i)) - 1;
+        while (mask) {
+            int k = 0;
+            while (!(mask & (1 << k))) ++k;
+            mask &= ~(1 << k);
+            int id = soa.sphereIndex[i + k];
+            if (t[k] < tMax || (t[k] == tMax && id < hitSphere)) {
+                tMax = t[k];
+                hitSphere = id;
+            }
+        }
+    }
+}
+
+bool RTAnyHitAVX2(const RTSphereSoA& soa, int first, int count,
+                  const glm::vec3& origin, const glm::vec3& dir, float tMax, int skipA, int skipB) {
+    float a = glm::dot(dir, dir);
+    __m256 ox = _mm256_set1_ps(origin.x), oy = _mm256_set1_ps(origin.y), oz = _mm256_set1_ps(origin.z);
+    __m256 dx = _mm256_set1_ps(dir.x), dy = _mm256_set1_ps(dir.y), dz = _mm256_set1_ps(dir.z);
+    __m256 twoA = _mm256_set1_ps(2.0f * a), fourA = _mm256_set1_ps(4 * a);
+    float t[8];
+    int end = first + count;
+    for (int i = first; i < end; i += 8) {
+        int mask = IntersectAVX2(soa, i, ox, oy, oz, dx, dy, dz, twoA, fourA, t);
+        if (end - i < 8) mask &= (1 << (end - i)) - 1;
+        for (int k = 0; k < 8; ++k) {
+            if (!(mask & (1 << k))) continue;
+            int id = soa.sphereIndex[i + k];
+            if (id != skipA && id != skipB && t[k] < tMax) return true;
+        }
+    }
+    return false;
+}
+
+// 光线包：每次取 8 条光线，对每个候选球体做一次 8 路测试，运算与 IntersectAVX2 相同
+void RTPacketClosestHitAVX2(const RTSphereSoA& soa, const int* candidates, int candidateCount, RTRayPacket& packet) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 four = _mm256_set1_ps(4.0f);
+    const __m256 eps = _mm256_set1_ps(0.001f);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    __m256 ox = _mm256_set1_ps(packet.origin.x), oy = _mm256_set1_ps(packet.origin.y), oz = _mm256_set1_ps(packet.origin.z);
+
+    for (int r = 0; r < packet.count; r += 8) {
+        __m256 dx = _mm256_loadu_ps(&packet.dirX[r]);
+        __m256 dy = _mm256_loadu_ps(&packet.dirY[r]);
+        __m256 dz = _mm256_loadu_ps(&packet.dirZ[r]);
+        __m256 a = _mm256_loadu_ps(&packet.dirDot[r]);
+        __m256 twoA = _mm256_mul_ps(two, a), fourA = _mm256_mul_ps(four, a);
+        __m256 tMax = _mm256_loadu_ps(&packet.tMax[r]);
+        __m256i hitSphere = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&packet.hitSphere[r]));
+
+        for (int c = 0; c < candidateCount; ++c) {
+            int i = candidates[c];
+            __m256 ocx = _mm256_sub_ps(ox, _mm256_set1_ps(soa.centerX[i]));
+            __m256 ocy = _mm256_sub_ps(oy, _mm256_set1_ps(soa.centerY[i]));
+            __m256 ocz = _mm256_sub_ps(oz, _mm256_set1_ps(soa.centerZ[i]));
+            __m256 b = _mm256_mul_ps(two, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocx, dx), _mm256_mul_ps(ocy, dy)),
+                                                        _mm256_mul_ps(ocz, dz)));
+            __m256 cc = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocx, ocx), _mm256_mul_ps(ocy, ocy)),
+                                                    _mm256_mul_ps(ocz, ocz)),
+                                      _mm256_set1_ps(soa.radius2[i]));
+            __m256 disc = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(fourA, cc));
+            __m256 hasRoot = _mm256_cmp_ps(disc, zero, _CMP_GE_OQ);
+            if (!_mm256_movemask_ps(hasRoot)) continue;
+
+            __m256 sq = _mm256_sqrt_ps(_mm256_max_ps(disc, zero));
+            __m256 negB = _mm256_xor_ps(b, signBit);
+            __m256 t1 = _mm256_div_ps(_mm256_sub_ps(negB, sq), twoA);
+            __m256 t2 = _mm256_div_ps(_mm256_add_ps(negB, sq), twoA);
+            __m256 t = _mm256_blendv_ps(t2, t1, _mm256_cmp_ps(t1, eps, _CMP_GT_OQ));
+            __m256 hit = _mm256_and_ps(hasRoot, _mm256_cmp_ps(t, eps, _CMP_GT_OQ));
+
+            // 更近，或距离相同且原始下标更小
+            __m256i id = _mm256_set1_epi32(soa.sphereIndex[i]);
+            __m256 smallerId = _mm256_castsi256_ps(_mm256_cmpgt_epi32(hitSphere, id));
+            __m256 closer = _mm256_and_ps(hit, _mm256_or_ps(_mm256_cmp_ps(t, tMax, _CMP_LT_OQ),
+                                                            _mm256_and_ps(_mm256_cmp_ps(t, tMax, _CMP_EQ_OQ), smallerId)));
+            tMax = _mm256_blendv_ps(tMax, t, closer);
+            hitSphere = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(hitSphere), _mm256_castsi256_ps(id), closer));
+        }
+        _mm256_storeu_ps(&packet.tMax[r], tMax);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&packet.hitSphere[r]), hitSphere);
+    }
+}
+
+// 每次 8 个方向，不足 8 个的尾部用标量版本
+void RTDirectionToUVAVX2(const float* x, const float* y, const float* z, int count, float* u, float* v) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 invTwoPi = _mm256_set1_ps(RTFastMathConst::InvTwoPi);
+    const __m256 invPi = _mm256_set1_ps(RTFastMathConst::InvPi);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 atan = RTFastAtan2AVX2(_mm256_loadu_ps(z + i), _mm256_loadu_ps(x + i));
+        __m256 asin = RTFastAsinAVX2(_mm256_loadu_ps(y + i));
+        _mm256_storeu_ps(u + i, _mm256_add_ps(half, _mm256_mul_ps(atan, invTwoPi)));
+        _mm256_storeu_ps(v + i, _mm256_sub_ps(half, _mm256_mul_ps(asin, invPi)));
+    }
+    for (; i < count; ++i) RTFastDirectionToUV(x[i], y[i], z[i], u[i], v[i]);
+}
+
+// 每次 8 个方向，选择逻辑同 SSE 版本，不足 8 个的尾部用标量版本
+void RTDirectionToCubeAVX2(const float* x, const float* y, const float* z, int count, int* face, float* s, float* t) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+        __m256 ax = _mm256_andnot_ps(signBit, vx), ay = _mm256_andnot_ps(signBit, vy), az = _mm256_andnot_ps(signBit, vz);
+        __m256 majorX = _mm256_and_ps(_mm256_cmp_ps(ax, ay, _CMP_GE_OQ), _mm256_cmp_ps(ax, az, _CMP_GE_OQ));
+        __m256 majorY = _mm256_cmp_ps(ay, az, _CMP_GE_OQ);
+        __m256 negX = _mm256_cmp_ps(vx, zero, _CMP_LT_OQ);
+        __m256 negY = _mm256_cmp_ps(vy, zero, _CMP_LT_OQ);
+        __m256 negZ = _mm256_cmp_ps(vz, zero, _CMP_LT_OQ);
+        __m256 mx = _mm256_xor_ps(vx, signBit), my = _mm256_xor_ps(vy, signBit), mz = _mm256_xor_ps(vz, signBit);
+
+        // blendv(b, a, mask)：mask 为真的通道取 a
+        __m256 ma = _mm256_blendv_ps(_mm256_blendv_ps(az, ay, majorY), ax, majorX);
+        __m256 sc = _mm256_blendv_ps(_mm256_blendv_ps(_mm256_blendv_ps(vx, mx, negZ), vx, majorY),
+                                     _mm256_blendv_ps(mz, vz, negX), majorX);
+        __m256 tc = _mm256_blendv_ps(_mm256_blendv_ps(my, _mm256_blendv_ps(vz, mz, negY), majorY), my, majorX);
+        __m256 f = _mm256_blendv_ps(_mm256_blendv_ps(_mm256_add_ps(_mm256_set1_ps(4.0f), _mm256_and_ps(negZ, one)),
+                                                     _mm256_add_ps(_mm256_set1_ps(2.0f), _mm256_and_ps(negY, one)),
+                                                     majorY),
+                                    _mm256_and_ps(negX, one), majorX);
+        __m256 scale = _mm256_div_ps(half, ma);
+        _mm256_storeu_ps(s + i, _mm256_add_ps(_mm256_mul_ps(sc, scale), half));
+        _mm256_storeu_ps(t + i, _mm256_add_ps(_mm256_mul_ps(tc, scale), half));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(face + i), _mm256_cvttps_epi32(f));
+    }
+    for (; i < count; ++i) face[i] = RTDirectionToCube(x[i], y[i], z[i], s[i], t[i]);
+}
+
+#endif // RT_HAVE_AVX2
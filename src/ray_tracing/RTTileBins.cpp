@@ -0,0 +1,116 @@
+#include "RTTileBins.h"
+#include <algorithm>
+#include <cmath>
+
+void RTTileBins::Build(const std::vector<RTSphereData>& spheres, const RTSphereSoA& soa,
+                       const glm::vec3& cameraPos, const glm::mat4& view, const glm::mat4& invProj,
+                       int w, int h) {
+    valid = false;
+    if (w <= 0 || h <= 0) return;
+
+    // 主光线在“以相机为原点、按 view 旋转”的坐标系中为 t * (sx, sy, -1)，
+    // 要求 view 的线性部分是旋转，球体半径才保持不变
+    rotation = glm::dmat3(glm::mat3(view));
+    glm::dmat3 gram = glm::transpose(rotation) * rotation;
+    for (int c = 0; c < 3; ++c) {
+        for (int r = 0; r < 3; ++r) {
+            if (std::fabs(gram[c][r] - (c == r ? 1.0 : 0.0)) > 1e-4) return;
+        }
+    }
+    camera = glm::dvec3(cameraPos);
+
+    // 斜率 (sx, sy) = invProj * (ndcX, ndcY, -1, 1) 的 xy 分量，是 NDC 的仿射函数，求它的逆
+    glm::dmat2 ndcToSlope(invProj[0][0], invProj[0][1], invProj[1][0], invProj[1][1]);
+    if (std::fabs(glm::determinant(ndcToSlope)) < 1e-12) return;
+    slopeToNdc = glm::inverse(ndcToSlope);
+    slopeOffset = glm::dvec2(invProj[3][0] - invProj[2][0], invProj[3][1] - invProj[2][1]);
+
+    width = w;
+    height = h;
+    binsX = (width + BinSize - 1) / BinSize;
+    binsY = (height + BinSize - 1) / BinSize;
+    int binCount = binsX * binsY;
+
+    // 计数 -> 前缀和 -> 填充；按 SoA 位置顺序登记，每个格子内自然升序
+    binStart.assign(binCount + 1, 0);
+    rects.resize(soa.count);
+    for (int i = 0; i < soa.count; ++i) {
+        const RTSphereData& sphere = spheres[soa.sphereIndex[i]];
+        BinRect rect = SphereBins(sphere.center, sphere.radius);
+        rects[i] = rect;
+        for (int by = rect.y0; by <= rect.y1; ++by) {
+            for (int bx = rect.x0; bx <= rect.x1; ++bx) ++binStart[by * binsX + bx + 1];
+        }
+    }
+    for (int b = 0; b < binCount; ++b) binStart[b + 1] += binStart[b];
+    binSpheres.resize(binStart[binCount]);
+    binFill.assign(binStart.begin(), binStart.end() - 1);
+    for (int i = 0; i < soa.count; ++i) {
+        const BinRect& rect = rects[i];
+        for (int by = rect.y0; by <= rect.y1; ++by) {
+            for (int bx = rect.x0; bx <= rect.x1; ++bx) binSpheres[binFill[by * binsX + bx]++] = i;
+        }
+    }
+    valid = true;
+}
+
+RTTileBins::BinRect RTTileBins::SphereBins(const glm::vec3& center, float radius) const {
+    const BinRect none = {0, 0, -1, -1};
+    const BinRect all = {0, 0, binsX - 1, binsY - 1};
+
+    glm::dvec3 v = rotation * (glm::dvec3(center) - camera);
+    double d = -v.z; // 沿视线方向的深度
+    double r = radius;
+    if (d < -r) return none;             // 完全在相机后方，主光线不会击中
+    if (d <= r * 1.0001 + 1e-6) return all; // 跨过相机平面（或包含相机），投影无界
+
+    // 过原点与球相切的直线斜率 s = x / d：(c·d ± r·sqrt(c² + d² - r²)) / (d² - r²)
+    double denom = d * d - r * r;
+    auto slopes = [&](double c, double& lo, double& hi) {
+        double k = r * std::sqrt(c * c + denom);
+        lo = (c * d - k) / denom;
+        hi = (c * d + k) / denom;
+    };
+    double sx[2], sy[2];
+    slopes(v.x, sx[0], sx[1]);
+    slopes(v.y, sy[0], sy[1]);
+
+    // 斜率矩形的四个角映射到 NDC，再到像素坐标（像素 x 的主光线在 px = x 处，抖动不超过半个像素）
+    double pxMin = 1e30, pxMax = -1e30, pyMin = 1e30, pyMax = -1e30;
+    for (int i = 0; i < 4; ++i) {
+        glm::dvec2 ndc = slopeToNdc * (glm::dvec2(sx[i & 1], sy[i >> 1]) - slopeOffset);
+        double px = (ndc.x + 1.0) * 0.5 * width;
+        double py = (1.0 - ndc.y) * 0.5 * height;
+        pxMin = std::min(pxMin, px);
+        pxMax = std::max(pxMax, px);
+        pyMin = std::min(pyMin, py);
+        pyMax = std::max(pyMax, py);
+    }
+
+    // 半个像素的抖动范围外再留一个像素的余量，吸收浮点误差
+    double x0 = std::floor(pxMin) - 1.0, x1 = std::ceil(pxMax) + 1.0;
+    double y0 = std::floor(pyMin) - 1.0, y1 = std::ceil(pyMax) + 1.0;
+    if (x1 < 0.0 || y1 < 0.0 || x0 > width - 1 || y0 > height - 1) return none;
+    BinRect rect;
+    rect.x0 = static_cast<int>(std::max(x0, 0.0)) / BinSize;
+    rect.x1 = static_cast<int>(std::min(x1, width - 1.0)) / BinSize;
+    rect.y0 = static_cast<int>(std::max(y0, 0.0)) / BinSize;
+    rect.y1 = static_cast<int>(std::min(y1, height - 1.0)) / BinSize;
+    return rect;
+}
+
+void RTTileBins::Gather(int x0, int y0, int x1, int y1, std::vector<int>& out) const {
+    out.clear();
+    int bx0 = x0 / BinSize, bx1 = (x1 - 1) / BinSize;
+    int by0 = y0 / BinSize, by1 = (y1 - 1) / BinSize;
+    for (int by = by0; by <= by1; ++by) {
+        for (int bx = bx0; bx <= bx1; ++bx) {
+            int bin = by * binsX + bx;
+            out.insert(out.end(), binSpheres.begin() + binStart[bin], binSpheres.begin() + binStart[bin + 1]);
+        }
+    }
+    if (bx0 != bx1 || by0 != by1) {
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+}
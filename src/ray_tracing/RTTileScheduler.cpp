@@ -0,0 +1,128 @@
+#include "RTTileScheduler.h"
+#include <algorithm>
+
+RTTileScheduler::RTTileScheduler(int n) {
+    SetThreadCount(n);
+}
+
+RTTileScheduler::~RTTileScheduler() {
+    StopWorkers();
+}
+
+void RTTileScheduler::SetThreadCount(int n) {
+    if (n <= 0) {
+        n = static_cast<int>(std::thread::hardware_concurrency());
+        if (n <= 0) n = 1;
+    }
+    if (n == threadCount && static_cast<int>(queues.size()) == n) return;
+
+    StopWorkers();
+    threadCount = n;
+    queues = std::vector<WorkQueue>(threadCount);
+    StartWorkers();
+}
+
+void RTTileScheduler::StartWorkers() {
+    stopping = false;
+    for (int i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&RTTileScheduler::WorkerLoop, this, i, frameId);
+    }
+}
+
+void RTTileScheduler::StopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        stopping = true;
+    }
+    frameStart.notify_all();
+    for (std::thread& t : workers) {
+        if (t.joinable()) t.join();
+    }
+    workers.clear();
+}
+
+void RTTileScheduler::WorkerLoop(int threadIndex, unsigned long long seenFrame) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(frameMutex);
+            frameStart.wait(lock, [&] { return stopping || frameId != seenFrame; });
+            if (stopping) return;
+            seenFrame = frameId;
+        }
+
+        ProcessTiles(threadIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(frameMutex);
+            if (--pendingWorkers == 0) frameDone.notify_one();
+        }
+    }
+}
+
+bool RTTileScheduler::PopTile(int threadIndex, int& tileIndex) {
+    // 先从自己队列的队首取（相邻分块，缓存友好）
+    {
+        WorkQueue& own = queues[threadIndex];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tiles.empty()) {
+            tileIndex = own.tiles.front();
+            own.tiles.pop_front();
+            return true;
+        }
+    }
+    // 自己做完了，从其他线程的队尾窃取
+    for (int k = 1; k < threadCount; ++k) {
+        WorkQueue& victim = queues[(threadIndex + k) % threadCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tiles.empty()) {
+            tileIndex = victim.tiles.back();
+            victim.tiles.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void RTTileScheduler::ProcessTiles(int threadIndex) {
+    int tileIndex;
+    while (PopTile(threadIndex, tileIndex)) {
+        (*job)(tiles[tileIndex], threadIndex);
+    }
+}
+
+void RTTileScheduler::Run(int width, int height, int tileSize, const std::function<void(const RTTile&, int)>& fn) {
+    if (width <= 0 || height <= 0) return;
+    tileSize = std::max(1, tileSize);
+
+    // 生成分块
+    tiles.clear();
+    for (int y = 0; y < height; y += tileSize) {
+        for (int x = 0; x < width; x += tileSize) {
+            tiles.push_back({x, y, std::min(x + tileSize, width), std::min(y + tileSize, height)});
+        }
+    }
+    job = &fn;
+
+    // 每个线程分到连续的一段分块
+    int tileCount = static_cast<int>(tiles.size());
+    for (int i = 0; i < threadCount; ++i) {
+        int begin = static_cast<int>(static_cast<long long>(tileCount) * i / threadCount);
+        int end = static_cast<int>(static_cast<long long>(tileCount) * (i + 1) / threadCount);
+        std::lock_guard<std::mutex> lock(queues[i].mutex);
+        queues[i].tiles.clear();
+        for (int t = begin; t < end; ++t) queues[i].tiles.push_back(t);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        pendingWorkers = threadCount - 1;
+        ++frameId;
+    }
+    frameStart.notify_all();
+
+    ProcessTiles(0);
+
+    std::unique_lock<std::mutex> lock(frameMutex);
+    frameDone.wait(lock, [&] { return pendingWorkers == 0; });
+    job = nullptr;
+}
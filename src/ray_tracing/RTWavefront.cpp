@@ -0,0 +1,273 @@
+#include "RayTracer.h"
+#include <algorithm>
+#include <limits>
+
+// ENGINE_WAVEFRONT：一批像素的路径逐层推进，每一阶段都在整批光线上并行执行
+//   主光线 -> 最近交点 -> 按类别排序 -> 各类着色（环境 / 自发光 / 反弹 / 直接光照）-> 阴影光线 -> 下一层
+// 与深度优先的 Trace 使用相同的运算与随机序列：每条路径保存自己的 RTRandom，
+// 各层反弹的反照率在路径结束后从最深一层开始逆序相乘，因此结果逐位相同
+
+static const int WavefrontChunk = 1024; // ParallelFor 的分段大小
+
+void RayTracer::TraceWavefront(const std::vector<RTSphereData>& spheres,
+                               const std::vector<RTMaterial>& materials,
+                               const std::vector<RTTextureHandle>& materialTextures,
+                               const glm::vec3& cameraPos,
+                               const glm::mat4& invView,
+                               const glm::mat4& invProj,
+                               int depth) {
+    int pixels = renderWidth * renderHeight;
+    for (int first = 0; first < pixels; first += WavefrontBatchSize) {
+        TraceWavefrontBatch(first, std::min(WavefrontBatchSize, pixels - first),
+                            spheres, materials, materialTextures, cameraPos, invView, invProj, depth);
+    }
+}
+
+void RayTracer::TraceWavefrontBatch(int firstPixel, int pixelCount,
+                                    const std::vector<RTSphereData>& spheres,
+                                    const std::vector<RTMaterial>& materials,
+                                    const std::vector<RTTextureHandle>& materialTextures,
+                                    const glm::vec3& cameraPos,
+                                    const glm::mat4& invView,
+                                    const glm::mat4& invProj,
+                                    int depth) {
+    RTWavefrontQueues& q = wavefront;
+    q.rng.resize(pixelCount, RTRandom(0));
+    q.color.resize(pixelCount);
+    q.rays.resize(pixelCount);
+    if (static_cast<int>(q.bounces.size()) < std::max(depth, 0) + 1) q.bounces.resize(std::max(depth, 0) + 1);
+
+    // 1. 主光线
+    ParallelFor(pixelCount, WavefrontChunk, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            int pixel = firstPixel + i;
+            int x = pixel % renderWidth;
+            int y = pixel / renderWidth;
+            q.rng[i] = PixelRandom(x, y);
+            q.rays[i].origin = cameraPos;
+            q.rays[i].dir = PrimaryRayDir(x, y, invView, invProj, q.rng[i]);
+            q.rays[i].path = i;
+            q.rays[i].cone = PrimaryCone();
+        }
+    });
+
+    bool sampleLights;
+    int lightIterations = LightIterations(sampleLights);
+
+    // 击中点、法线与表面反照率，与 Trace 中的计算相同
+    auto surface = [&](int i, glm::vec3& hitPoint, glm::vec3& normal, glm::vec3& albedo) -> const RTSphereData& {
+        const RTWavefrontQueues::Ray& ray = q.rays[i];
+        const RTSphereData& sphere = spheres[q.hitSphere[i]];
+        hitPoint = ray.origin + ray.dir * q.hitT[i];
+        normal = glm::normalize(hitPoint - sphere.center);
+        float footprint = RTSphereFootprintAngle(ray.cone, q.hitT[i], sphere.radius, ray.dir, normal);
+        albedo = SurfaceAlbedo(sphere, materials[sphere.materialIndex], normal, footprint, materialTextures);
+        return sphere;
+    };
+
+    int levels = 0;
+    for (int level = 0; !q.rays.empty(); ++level) {
+        int remaining = depth - level; // 对应 Trace 中剩余的反弹次数
+        int count = static_cast<int>(q.rays.size());
+        q.hitSphere.resize(count);
+        q.hitT.resize(count);
+        q.hitClass.resize(count);
+
+        // 2. 最近交点与分类
+        ParallelFor(count, WavefrontChunk, [&](int begin, int end) {
+            RTRayCounters& counters = ThreadCounters();
+            for (int i = begin; i < end; ++i) {
+                if (level == 0) ++counters.primaryRays;
+                else ++counters.secondaryRays;
+                ++counters.depthHistogram[std::min(level, RTRayCounters::DepthBins - 1)];
+
+                const RTWavefrontQueues::Ray& ray = q.rays[i];
+                float closestT = std::numeric_limits<float>::max();
+                int closestSphereIdx = -1;
+                int pixel = firstPixel + ray.path;
+                RTRayHit hit;
+                if (level == 0 && BinnedPrimaryHit(pixel % renderWidth, pixel / renderWidth, ray.origin, ray.dir, hit)) {
+                    closestT = hit.t;
+                    closestSphereIdx = hit.sphere;
+                } else {
+                    bvh.ClosestHit(ray.origin, ray.dir, closestT, [&](int first, int n, float& tMax) {
+                        ++counters.leafVisits;
+                        counters.sphereTests += n;
+                        simdKernels.closestHit(sphereSoA, first, n, ray.origin, ray.dir, tMax, closestSphereIdx);
+                    });
+                }
+                q.hitSphere[i] = closestSphereIdx;
+                q.hitT[i] = closestT;
+
+                unsigned char hitClass = WAVEFRONT_MISS;
+                if (closestSphereIdx >= 0) {
+                    const RTMaterial& mat = materials[spheres[closestSphereIdx].materialIndex];
+                    if (RTLightList::IsEmissive(mat)) hitClass = WAVEFRONT_EMISSIVE;
+                    else if (remaining > 0 && mat.type == MaterialType::SPECULAR) hitClass = WAVEFRONT_SPECULAR;
+                    else if (remaining > 0 && mat.type == MaterialType::REFRACTIVE) hitClass = WAVEFRONT_REFRACTIVE;
+                    else hitClass = WAVEFRONT_SHADE;
+                }
+                q.hitClass[i] = hitClass;
+            }
+        });
+
+        // 3. 按类别稳定排序（计数排序），同类光线连续着色
+        int fill[WAVEFRONT_CLASS_COUNT] = {};
+        for (int i = 0; i < count; ++i) ++fill[q.hitClass[i]];
+        q.classBegin[0] = 0;
+        for (int c = 0; c < WAVEFRONT_CLASS_COUNT; ++c) {
+            q.classBegin[c + 1] = q.classBegin[c] + fill[c];
+            fill[c] = q.classBegin[c];
+        }
+        q.sorted.resize(count);
+        for (int i = 0; i < count; ++i) q.sorted[fill[q.hitClass[i]]++] = i;
+
+        // 4a. 未击中：环境贴图
+        int missBegin = q.classBegin[WAVEFRONT_MISS];
+        int missCount = q.classBegin[WAVEFRONT_MISS + 1] - missBegin;
+        // 立方体贴图总是批量换算（不涉及超越函数，与逐条换算逐位一致）；等距柱状投影只在 FAST 精度下批量换算
+        bool batchCube = hasEnvironmentTexture && !environmentCube.Empty();
+        bool batchUV = hasEnvironmentTexture && !batchCube && options.mathPrecision == MATH_PRECISION_FAST;
+        if (batchUV || batchCube) {
+            q.missX.resize(missCount);
+            q.missY.resize(missCount);
+            q.missZ.resize(missCount);
+            q.missU.resize(missCount);
+            q.missV.resize(missCount);
+        }
+        if (batchCube) q.missFace.resize(missCount);
+        ParallelFor(missCount, WavefrontChunk, [&](int begin, int end) {
+            RTRayCounters& counters = ThreadCounters();
+            if (batchUV || batchCube) {
+                for (int k = begin; k < end; ++k) {
+                    const glm::vec3& dir = q.rays[q.sorted[missBegin + k]].dir;
+                    q.missX[k] = dir.x;
+                    q.missY[k] = dir.y;
+                    q.missZ[k] = dir.z;
+                }
+            }
+            if (batchUV) {
+                simdKernels.directionToUV(&q.missX[begin], &q.missY[begin], &q.missZ[begin], end - begin,
+                                          &q.missU[begin], &q.missV[begin]);
+            } else if (batchCube) {
+                simdKernels.directionToCube(&q.missX[begin], &q.missY[begin], &q.missZ[begin], end - begin,
+                                            &q.missFace[begin], &q.missU[begin], &q.missV[begin]);
+            }
+            for (int k = begin; k < end; ++k) {
+                const RTWavefrontQueues::Ray& ray = q.rays[q.sorted[missBegin + k]];
+                if (hasEnvironmentTexture) ++counters.environmentSamples;
+                if (batchCube) q.color[ray.path] = SampleEnvironmentCube(q.missFace[k], q.missU[k], q.missV[k], ray.cone.spread);
+                else if (batchUV) q.color[ray.path] = SampleEnvironmentUV(q.missU[k], q.missV[k], ray.cone.spread);
+                else q.color[ray.path] = SampleEnvironment(ray.dir, ray.cone.spread);
+            }
+        });
+
+        // 4b. 光源：自发光
+        int emissiveBegin = q.classBegin[WAVEFRONT_EMISSIVE];
+        ParallelFor(q.classBegin[WAVEFRONT_EMISSIVE + 1] - emissiveBegin, WavefrontChunk, [&](int begin, int end) {
+            for (int k = begin; k < end; ++k) {
+                int i = q.sorted[emissiveBegin + k];
+                glm::vec3 hitPoint, normal, albedo;
+                const RTSphereData& sphere = surface(i, hitPoint, normal, albedo);
+                const RTMaterial& mat = materials[sphere.materialIndex];
+                q.color[q.rays[i].path] = mat.emission * albedo;
+            }
+        });
+
+        // 4c. 镜面反射与折射：记录反照率，产生下一层光线
+        int bounceBegin = q.classBegin[WAVEFRONT_SPECULAR];
+        int bounceCount = q.classBegin[WAVEFRONT_REFRACTIVE + 1] - bounceBegin;
+        std::vector<RTWavefrontQueues::Bounce>& bounces = q.bounces[level];
+        bounces.resize(bounceCount);
+        q.nextRays.resize(bounceCount);
+        ParallelFor(bounceCount, WavefrontChunk, [&](int begin, int end) {
+            for (int k = begin; k < end; ++k) {
+                int i = q.sorted[bounceBegin + k];
+                glm::vec3 hitPoint, normal, albedo;
+                const RTSphereData& sphere = surface(i, hitPoint, normal, albedo);
+                const RTMaterial& mat = materials[sphere.materialIndex];
+                RTWavefrontQueues::Ray next = q.rays[i];
+                NextBounce(mat, hitPoint, normal, next.origin, next.dir);
+                next.cone = RTBounceCone(q.rays[i].cone, q.hitT[i], sphere.radius, mat.type);
+                q.nextRays[k] = next;
+                bounces[k].path = next.path;
+                bounces[k].albedo = albedo;
+            }
+        });
+
+        // 4d-6. 直接光照：每个着色点 lightIterations 个阴影光线槽；光源很多时把着色点分段处理，
+        // 使每段的槽数不超过 WavefrontShadowBudget（队列大小与光源数无关，结果与一次处理相同）
+        int shadeBegin = q.classBegin[WAVEFRONT_SHADE];
+        int shadeCount = q.classBegin[WAVEFRONT_SHADE + 1] - shadeBegin;
+        int shadeChunk = std::max(1, WavefrontShadowBudget / std::max(lightIterations, 1));
+        for (int chunkBegin = 0; chunkBegin < shadeCount; chunkBegin += shadeChunk) {
+            int chunkCount = std::min(shadeChunk, shadeCount - chunkBegin);
+            int shadowCount = static_cast<int>(static_cast<size_t>(chunkCount) * lightIterations);
+            q.shadeColor.resize(chunkCount);
+            q.shadowRays.resize(shadowCount);
+            q.shadowState.resize(shadowCount);
+
+            // 4d. 环境光项，并为每个光源生成阴影光线
+            ParallelFor(chunkCount, WavefrontChunk, [&](int begin, int end) {
+                for (int k = begin; k < end; ++k) {
+                    int i = q.sorted[shadeBegin + chunkBegin + k];
+                    glm::vec3 hitPoint, normal, albedo;
+                    surface(i, hitPoint, normal, albedo);
+                    glm::vec3 viewDir = glm::normalize(-q.rays[i].dir);
+
+                    glm::vec3 finalColor = glm::vec3(0.0f);
+                    float ambientStrength = 0.1f;
+                    glm::vec3 ambient = ambientStrength * albedo;
+                    finalColor += ambient;
+                    q.shadeColor[k] = finalColor;
+
+                    RTRandom& rng = q.rng[q.rays[i].path];
+                    for (int l = 0; l < lightIterations; ++l) {
+                        size_t slot = static_cast<size_t>(k) * lightIterations + l;
+                        bool used = SampleLight(l, sampleLights, hitPoint, normal, viewDir, albedo, q.hitSphere[i],
+                                                rng, q.shadowRays[slot]);
+                        q.shadowState[slot] = used ? 1 : 0;
+                    }
+                }
+            });
+
+            // 5. 阴影光线批量测试
+            ParallelFor(shadowCount, WavefrontChunk, [&](int begin, int end) {
+                for (int s = begin; s < end; ++s) {
+                    if (q.shadowState[s] == 1 && Occluded(q.shadowRays[s])) q.shadowState[s] = 2;
+                }
+            });
+
+            // 6. 按光源顺序累加未被遮挡的贡献（与 ShadeDirect 的加法顺序相同）
+            ParallelFor(chunkCount, WavefrontChunk, [&](int begin, int end) {
+                for (int k = begin; k < end; ++k) {
+                    glm::vec3 finalColor = q.shadeColor[k];
+                    for (int l = 0; l < lightIterations; ++l) {
+                        size_t slot = static_cast<size_t>(k) * lightIterations + l;
+                        if (q.shadowState[slot] == 1) finalColor += q.shadowRays[slot].contribution;
+                    }
+                    q.color[q.rays[q.sorted[shadeBegin + chunkBegin + k]].path] = glm::clamp(finalColor, 0.0f, 1.0f);
+                }
+            });
+        }
+
+        std::swap(q.rays, q.nextRays);
+        levels = level + 1;
+    }
+
+    // 7. 从最深一层开始逆序乘上反照率（每条路径在每层最多反弹一次）
+    for (int level = levels - 1; level >= 0; --level) {
+        const std::vector<RTWavefrontQueues::Bounce>& bounces = q.bounces[level];
+        ParallelFor(static_cast<int>(bounces.size()), WavefrontChunk, [&](int begin, int end) {
+            for (int k = begin; k < end; ++k) q.color[bounces[k].path] = bounces[k].albedo * q.color[bounces[k].path];
+        });
+    }
+
+    // 8. 写入像素（含渐进累加）
+    ParallelFor(pixelCount, WavefrontChunk, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            int pixel = firstPixel + i;
+            WritePixel(pixel % renderWidth, pixel / renderWidth, q.color[i]);
+        }
+    });
+}
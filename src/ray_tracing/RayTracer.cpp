@@ -1,275 +1,318 @@
 #include "RayTracer.h"
-#include <glad.h>
-#include <glfw3.h>
 #include <iostream>
 #include <algorithm>
 #include <limits>
 #include <cmath>
+#include <chrono>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
+// 当前线程的计数；每个分块（行）开始时清零、结束时并入该线程的合计，避免线程间争用
+static thread_local RTRayCounters tlsCounters;
+// 当前像素到达的最深递归层，供调试视图使用
+static thread_local int tlsPixelMaxLevel = 0;
+// 主光线包视锥内的候选球体（SoA 位置），每个线程复用
+static thread_local std::vector<int> tlsPacketCandidates;
 
-// 简单的顶点着色器：绘制全屏四边形
-const char* screenVertexShaderSource = R"(
-#version 330 core
-layout (location = 0) in vec2 aPos;
-layout (location = 1) in vec2 aTexCoords;
+void RTRayCounters::Add(const RTRayCounters& other) {
+    primaryRays += other.primaryRays;
+    secondaryRays += other.secondaryRays;
+    shadowRays += other.shadowRays;
+    leafVisits += other.leafVisits;
+    sphereTests += other.sphereTests;
+    textureSamples += other.textureSamples;
+    environmentSamples += other.environmentSamples;
+    for (int i = 0; i < DepthBins; ++i) depthHistogram[i] += other.depthHistogram[i];
+}
 
-out vec2 TexCoords;
+RayTracer::RayTracer(int w, int h) : width(w), height(h), renderWidth(w), renderHeight(h),
+                                     frameBuffers(&memoryBuffers),
+                                     tileScheduler(0), simdKernels(RTGetSimdKernels(SIMD_AUTO)) {
+    for (int i = 0; i < RTFrameBuffers::SlotCount; ++i) slotState[i] = SLOT_FREE;
+    memoryBuffers.Resize(width, height);
+}
 
-void main()
-{
-    TexCoords = aTexCoords;
-    gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0); 
+void RayTracer::SetFrameBuffers(RTFrameBuffers* buffers) {
+    std::unique_lock<std::mutex> lock = LockAsyncIdle();
+    frameBuffers = buffers ? buffers : &memoryBuffers;
+    frameBuffers->Resize(width, height);
+    for (int i = 0; i < RTFrameBuffers::SlotCount; ++i) slotState[i] = SLOT_FREE;
+    readySlot = presentedSlot = -1;
 }
-)";
 
-// 简单的片段着色器：显示纹理
-const char* screenFragmentShaderSource = R"(
-#version 330 core
-out vec4 FragColor;
-in vec2 TexCoords;
-uniform sampler2D screenTexture;
-void main()
-{
-    FragColor = texture(screenTexture, TexCoords);
+void RayTracer::SetOptions(const RTRenderOptions& o) {
+    std::unique_lock<std::mutex> lock = LockAsyncIdle();
+    if (o.textureLayout != options.textureLayout) {
+        for (RTMipTexture& mip : mipRegistry) mip.SetLayout(o.textureLayout);
+        environmentMip.SetLayout(o.textureLayout);
+        environmentCube.SetLayout(o.textureLayout);
+    }
+    options = o;
+    options.tileSize = std::max(1, options.tileSize);
+    options.packetSize = options.packetSize > 1 ? std::min(options.packetSize, 8) : 0;
+    tileScheduler.SetThreadCount(options.threadCount);
+    simdKernels = RTGetSimdKernels(options.simdLevel);
+    options.minRenderScale = glm::clamp(options.minRenderScale, 0.05f, 1.0f);
+    options.maxRenderScale = glm::clamp(options.maxRenderScale, options.minRenderScale, 1.0f);
+    options.renderScale = glm::clamp(options.renderScale, 0.05f, 1.0f);
+    if (options.dynamicResolution) {
+        options.renderScale = glm::clamp(options.renderScale, options.minRenderScale, options.maxRenderScale);
+    }
+    smoothedFrameMs = 0.0;
+    ApplyRenderScale(options.renderScale);
+    ClearAccumulation();
 }
-)";
 
-RayTracer::RayTracer(int w, int h) : width(w), height(h), textureID(0) {
-    pixelBuffer.resize(width * height * 3);
-    InitGLResources();
+void RayTracer::ResetAccumulation() {
+    // 异步模式下工作线程在追踪期间读写 accumulatedSamples，等它空闲后再清零
+    std::unique_lock<std::mutex> lock = LockAsyncIdle();
+    ClearAccumulation();
+}
+
+void RayTracer::ClearAccumulation() {
+    accumulatedSamples = 0;
 }
 
 RayTracer::~RayTracer() {
-    if (textureID) glDeleteTextures(1, &textureID);
-    if (quadVAO) glDeleteVertexArrays(1, &quadVAO);
-    if (quadVBO) glDeleteBuffers(1, &quadVBO);
-    if (screenShaderProgram) glDeleteProgram(screenShaderProgram);
+    StopAsync();
 }
 
 void RayTracer::Resize(int w, int h) {
+    std::unique_lock<std::mutex> lock = LockAsyncIdle();
     width = w;
     height = h;
-    pixelBuffer.resize(width * height * 3);
-    
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-}
-
-void RayTracer::InitGLResources() {
-    // 创建纹理
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-
-    // 创建全屏四边形
-    float quadVertices[] = { 
-        // positions   // texCoords
-        -1.0f,  1.0f,  0.0f, 1.0f,
-        -1.0f, -1.0f,  0.0f, 0.0f,
-         1.0f, -1.0f,  1.0f, 0.0f,
-
-        -1.0f,  1.0f,  0.0f, 1.0f,
-         1.0f, -1.0f,  1.0f, 0.0f,
-         1.0f,  1.0f,  1.0f, 1.0f
-    };
+    renderWidth = renderHeight = 0; // 强制按新尺寸重新计算
+    ApplyRenderScale(renderScale);
 
-    glGenVertexArrays(1, &quadVAO);
-    glGenBuffers(1, &quadVBO);
-    glBindVertexArray(quadVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-
-    SetupScreenShader();
-}
-
-void RayTracer::SetupScreenShader() {
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &screenVertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    // Check errors...
-
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &screenFragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    // Check errors...
-
-    screenShaderProgram = glCreateProgram();
-    glAttachShader(screenShaderProgram, vertexShader);
-    glAttachShader(screenShaderProgram, fragmentShader);
-    glLinkProgram(screenShaderProgram);
-    
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-}
-
-bool RayTracer::IntersectSphere(const glm::vec3& origin, const glm::vec3& dir, const RTSphereData& sphere, float& t) {
-    glm::vec3 oc = origin - sphere.center;
-    float a = glm::dot(dir, dir);
-    float b = 2.0f * glm::dot(oc, dir);
-    float c = glm::dot(oc, oc) - sphere.radius * sphere.radius;
-    float discriminant = b * b - 4 * a * c;
-    
-    if (discriminant < 0) {
-        return false;
-    } else {
-        float t1 = (-b - sqrt(discriminant)) / (2.0f * a);
-        if (t1 > 0.001f) {
-            t = t1;
-            return true;
-        }
-        float t2 = (-b + sqrt(discriminant)) / (2.0f * a);
-        if (t2 > 0.001f) {
-            t = t2;
-            return true;
-        }
-    }
-    return false;
+    // 旧尺寸的结果不再显示，按新尺寸重新分配输出缓冲
+    frameBuffers->Resize(width, height);
+    for (int i = 0; i < RTFrameBuffers::SlotCount; ++i) slotState[i] = SLOT_FREE;
+    readySlot = presentedSlot = -1;
 }
 
-glm::vec3 RayTracer::SampleTexture(const RTTexture& tex, float u, float v) {
-    if (tex.data.empty()) return glm::vec3(1.0f, 0.0f, 1.0f); // 错误紫
+void RayTracer::ApplyRenderScale(float scale) {
+    renderScale = scale;
+    int w = std::max(1, static_cast<int>(width * scale + 0.5f));
+    int h = std::max(1, static_cast<int>(height * scale + 0.5f));
+    if (w == renderWidth && h == renderHeight) return;
+    renderWidth = w;
+    renderHeight = h;
+    ClearAccumulation();
+}
 
-    // 简单的重复模式 (Repeat)
-    u = u - floor(u);
-    v = v - floor(v);
+void RayTracer::UpdateDynamicResolution(double frameMs) {
+    if (!options.dynamicResolution || frameMs <= 0.0) return;
+    // 指数平滑，避免单帧抖动引起分辨率来回跳动
+    smoothedFrameMs = smoothedFrameMs > 0.0 ? smoothedFrameMs * 0.7 + frameMs * 0.3 : frameMs;
 
-    int x = static_cast<int>(u * tex.width);
-    int y = static_cast<int>(v * tex.height);
+    // 追踪耗时大致与像素数（scale²）成正比；单帧最多缩小一半、放大 25%
+    float ratio = static_cast<float>(std::sqrt(options.targetFrameMs / smoothedFrameMs));
+    ratio = glm::clamp(ratio, 0.5f, 1.25f);
+    float scale = glm::clamp(renderScale * ratio, options.minRenderScale, options.maxRenderScale);
 
-    // 边界检查
-    x = std::max(0, std::min(x, tex.width - 1));
-    y = std::max(0, std::min(y, tex.height - 1));
+    // 变化小于 5% 时保持不变（滞回），减少缓冲重新分配与渐进累加的重置
+    if (std::fabs(scale - renderScale) > 0.05f * renderScale) {
+        ApplyRenderScale(scale);
+        smoothedFrameMs = 0.0;
+    }
+}
+
+glm::vec3 RayTracer::SampleEnvironment(const glm::vec3& dir, float spread) {
+    if (!hasEnvironmentTexture) {
+        return glm::vec3(0.0f);
+    }
 
-    int index = (y * tex.width + x) * tex.channels;
-    
-    float r = tex.data[index] / 255.0f;
-    float g = r;
-    float b = r;
-    if (tex.channels > 1) {
-        g = tex.data[index + 1] / 255.0f;
+    if (!environmentCube.Empty()) {
+        float s, t;
+        int face = RTDirectionToCube(dir.x, dir.y, dir.z, s, t);
+        return SampleEnvironmentCube(face, s, t, spread);
     }
-    if (tex.channels > 2) {
-        b = tex.data[index + 2] / 255.0f;
+    float u, v;
+    RTDirectionToUV(dir, u, v, options.mathPrecision);
+    return SampleEnvironmentUV(u, v, spread);
+}
+
+glm::vec3 RayTracer::SampleEnvironmentUV(float u, float v, float spread) {
+    if (!hasEnvironmentTexture) {
+        return glm::vec3(0.0f);
     }
 
-    return glm::vec3(r, g, b);
+    if (options.textureFilter == TEXTURE_FILTER_POINT) {
+        return RTSampleTexture(environmentTexture, u, v) * environmentIntensity;
+    }
+    float lod = options.textureFilter == TEXTURE_FILTER_TRILINEAR ? RTMipLevelForAngle(environmentMip, spread) : 0.0f;
+    return RTSampleMip(environmentMip, u, v, lod) * environmentIntensity;
 }
 
-glm::vec3 RayTracer::SampleEnvironment(const glm::vec3& dir) {
+glm::vec3 RayTracer::SampleEnvironmentCube(int face, float s, float t, float spread) {
     if (!hasEnvironmentTexture) {
         return glm::vec3(0.0f);
     }
 
-    const float invTwoPi = 1.0f / (2.0f * M_PI);
-    const float invPi = 1.0f / M_PI;
-    float u = 0.5f + atan2(dir.z, dir.x) * invTwoPi;
-    float v = 0.5f - asin(dir.y) * invPi;
-    glm::vec3 color = SampleTexture(environmentTexture, u, v);
-    return color * environmentIntensity;
+    if (options.textureFilter == TEXTURE_FILTER_POINT) {
+        return RTSampleCubeNearest(environmentCube, face, s, t) * environmentIntensity;
+    }
+    float lod = options.textureFilter == TEXTURE_FILTER_TRILINEAR ? RTMipLevelForCubeAngle(environmentCube, spread) : 0.0f;
+    return RTSampleCube(environmentCube, face, s, t, lod) * environmentIntensity;
 }
 
-glm::vec3 RayTracer::Trace(const glm::vec3& origin, const glm::vec3& dir, 
+glm::vec3 RayTracer::Trace(const glm::vec3& primaryOrigin, const glm::vec3& primaryDir,
                           const std::vector<RTSphereData>& spheres, 
                           const std::vector<RTMaterial>& materials, 
-                          const std::vector<RTTexture>& textures,
-                          int depth) {
-    // 1. 寻找最近交点
-    float closestT = std::numeric_limits<float>::max();
-    int closestSphereIdx = -1;
-
-    for (size_t i = 0; i < spheres.size(); ++i) {
-        float t;
-        if (IntersectSphere(origin, dir, spheres[i], t)) {
-            if (t < closestT) {
-                closestT = t;
-                closestSphereIdx = i;
-            }
+                          const std::vector<RTTextureHandle>& materialTextures,
+                          int maxDepth,
+                          RTRandom& rng,
+                          const RTRayHit* primaryHit) {
+    RTRayCounters& counters = tlsCounters;
+    glm::vec3 origin = primaryOrigin;
+    glm::vec3 dir = primaryDir;
+    RTRayCone cone = PrimaryCone();
+    int depth = maxDepth;
+
+    // 镜面 / 折射路径上各次反弹的反照率；结束时从最后一次反弹开始逆序相乘，
+    // 与递归实现在返回途中的乘法顺序一致，结果逐位相同
+    glm::vec3 localAlbedos[PathStackSize];
+    std::vector<glm::vec3> extraAlbedos; // 反弹次数超过 PathStackSize 时使用
+    int bounces = 0;
+
+    glm::vec3 color;
+    for (;;) {
+        int level = frameDepth - depth;
+        if (level == 0) ++counters.primaryRays;
+        else ++counters.secondaryRays;
+        ++counters.depthHistogram[std::min(std::max(level, 0), RTRayCounters::DepthBins - 1)];
+        if (level > tlsPixelMaxLevel) tlsPixelMaxLevel = level;
+
+        // 1. 寻找最近交点
+        float closestT = std::numeric_limits<float>::max();
+        int closestSphereIdx = -1;
+
+        if (primaryHit) { // 主光线包已经求出
+            closestT = primaryHit->t;
+            closestSphereIdx = primaryHit->sphere;
+            primaryHit = nullptr;
+        } else {
+            // 叶子内的球体在 sphereSoA 中连续存放，一次 SIMD 测试多个球体
+            bvh.ClosestHit(origin, dir, closestT, [&](int first, int count, float& tMax) {
+                ++counters.leafVisits;
+                counters.sphereTests += count;
+                simdKernels.closestHit(sphereSoA, first, count, origin, dir, tMax, closestSphereIdx);
+            });
+        }
+
+        // 2. 未击中处理：返回背景色
+        if (closestSphereIdx == -1) {
+            if (hasEnvironmentTexture) ++counters.environmentSamples;
+            color = SampleEnvironment(dir, cone.spread);
+            break;
         }
+
+        const RTSphereData& hitSphere = spheres[closestSphereIdx];
+        const RTMaterial& hitMat = materials[hitSphere.materialIndex];
+        glm::vec3 hitPoint = origin + dir * closestT;
+        glm::vec3 normal = glm::normalize(hitPoint - hitSphere.center);
+        float footprint = RTSphereFootprintAngle(cone, closestT, hitSphere.radius, dir, normal);
+        glm::vec3 albedo = SurfaceAlbedo(hitSphere, hitMat, normal, footprint, materialTextures);
+
+        // 如果是发光体，直接返回自发光颜色 (混合纹理颜色)
+        if (RTLightList::IsEmissive(hitMat)) {
+            color = hitMat.emission * albedo; // 简单的混合
+            break;
+        }
+
+        // 镜面反射与折射：记录反照率，以新的光线继续循环（原先的递归）
+        if (depth > 0 && NextBounce(hitMat, hitPoint, normal, origin, dir)) {
+            cone = RTBounceCone(cone, closestT, hitSphere.radius, hitMat.type);
+            if (bounces < PathStackSize) localAlbedos[bounces] = albedo;
+            else extraAlbedos.push_back(albedo);
+            ++bounces;
+            --depth;
+            continue;
+        }
+
+        // 3. 光照计算 (Phong Model)
+        color = ShadeDirect(hitPoint, normal, dir, albedo, closestSphereIdx, rng);
+        break;
     }
 
-    // 2. 未击中处理：返回背景色
-    if (closestSphereIdx == -1) {
-        return SampleEnvironment(dir);
+    for (int i = bounces - 1; i >= 0; --i) {
+        color = (i < PathStackSize ? localAlbedos[i] : extraAlbedos[i - PathStackSize]) * color;
     }
+    return color;
+}
 
-    const RTSphereData& hitSphere = spheres[closestSphereIdx];
-    const RTMaterial& hitMat = materials[hitSphere.materialIndex];
-    
+glm::vec3 RayTracer::SurfaceAlbedo(const RTSphereData& hitSphere, const RTMaterial& hitMat, const glm::vec3& normal,
+                                   float footprint, const std::vector<RTTextureHandle>& materialTextures) {
     // 计算纹理颜色
     glm::vec3 albedo = hitMat.color;
-    
-    // 如果有纹理数据，进行采样
-    // 假设 materialIndex 对应 textureIndex
-    if (hitSphere.materialIndex >= 0 && hitSphere.materialIndex < textures.size()) {
-        const RTTexture& tex = textures[hitSphere.materialIndex];
-        if (!tex.data.empty()) {
-            glm::vec3 hitPoint = origin + dir * closestT;
-            glm::vec3 localPoint = hitPoint - hitSphere.center;
-            glm::vec3 normal = glm::normalize(localPoint);
-            
-            // 球面 UV 映射
-            // u = 0.5 + atan2(z, x) / (2*pi)
-            // v = 0.5 - asin(y) / pi
-            const float invTwoPi = 1.0f / (2.0f * M_PI);
-            const float invPi = 1.0f / M_PI;
-            float u = 0.5f + atan2(normal.z, normal.x) * invTwoPi;
-            float v = 0.5f - asin(normal.y) * invPi;
-            
-            albedo = SampleTexture(tex, u, v);
+
+    // 如果材质绑定了纹理，进行采样
+    const RTTexture* texPtr = nullptr;
+    RTTextureHandle handle = RT_INVALID_TEXTURE;
+    if (hitSphere.materialIndex >= 0 && hitSphere.materialIndex < static_cast<int>(materialTextures.size())) {
+        handle = materialTextures[hitSphere.materialIndex];
+        texPtr = GetTexture(handle);
+    }
+    if (texPtr && !texPtr->data.empty()) {
+        // 球面 UV 映射
+        float u, v;
+        RTDirectionToUV(normal, u, v, options.mathPrecision);
+        if (options.textureFilter == TEXTURE_FILTER_POINT) {
+            albedo = RTSampleTexture(*texPtr, u, v);
+        } else {
+            const RTMipTexture& mip = mipRegistry[handle];
+            float lod = options.textureFilter == TEXTURE_FILTER_TRILINEAR ? RTMipLevelForAngle(mip, footprint) : 0.0f;
+            albedo = RTSampleMip(mip, u, v, lod);
         }
+        ++tlsCounters.textureSamples;
     }
+    return albedo;
+}
 
-    // 如果是发光体，直接返回自发光颜色 (混合纹理颜色)
-    if (glm::length(hitMat.emission) > 0.1f) {
-        return hitMat.emission * albedo; // 简单的混合
-    }
+bool RayTracer::NextBounce(const RTMaterial& hitMat, const glm::vec3& hitPoint, const glm::vec3& normal,
+                           glm::vec3& origin, glm::vec3& dir) {
+    if (hitMat.type == MaterialType::REFRACTIVE) {
+        glm::vec3 n = normal;
+        glm::vec3 viewDir = glm::normalize(dir);
+        float eta = 1.0f / (hitMat.ior > 0.0f ? hitMat.ior : 1.0f); // 假设空气折射率为1.0
 
-    glm::vec3 hitPoint = origin + dir * closestT;
-    glm::vec3 normal = glm::normalize(hitPoint - hitSphere.center);
-    
-    // --- 递归光线追踪逻辑 (处理透明/折射和镜面反射) ---
-    if (depth > 0) {
-        if (hitMat.type == MaterialType::REFRACTIVE) {
-            glm::vec3 n = normal;
-            glm::vec3 viewDir = glm::normalize(dir);
-            float eta = 1.0f / (hitMat.ior > 0.0f ? hitMat.ior : 1.0f); // 假设空气折射率为1.0
+        // 判断是射入还是射出 (法线方向与光线方向点积)
+        if (glm::dot(viewDir, n) > 0) {
+            n = -n; // 内部射出，法线反转
+            eta = hitMat.ior; // 恢复折射率比 (Material -> Air)
+        }
 
-            // 判断是射入还是射出 (法线方向与光线方向点积)
-            if (glm::dot(viewDir, n) > 0) {
-                n = -n; // 内部射出，法线反转
-                eta = hitMat.ior; // 恢复折射率比 (Material -> Air)
-            }
+        glm::vec3 refractDir = glm::refract(viewDir, n, eta);
 
-            glm::vec3 refractDir = glm::refract(viewDir, n, eta);
-            
-            if (glm::length(refractDir) > 0.0001f) {
-                // 发生折射
-                // 偏移起点以防自相交 (向折射方向偏移)
-                return albedo * Trace(hitPoint + refractDir * 0.001f, refractDir, spheres, materials, textures, depth - 1);
-            } else {
-                // 全内反射 (Total Internal Reflection) -> 视为镜面反射
-                glm::vec3 reflectDir = glm::reflect(viewDir, n);
-                return albedo * Trace(hitPoint + reflectDir * 0.001f, reflectDir, spheres, materials, textures, depth - 1);
-            }
-        }
-        else if (hitMat.type == MaterialType::SPECULAR) {
-            // 镜面反射
-            glm::vec3 reflectDir = glm::reflect(dir, normal);
-            // 偏移起点以防自相交 (向法线方向偏移)
-            return albedo * Trace(hitPoint + normal * 0.001f, reflectDir, spheres, materials, textures, depth - 1);
+        if (glm::length(refractDir) > 0.0001f) {
+            // 发生折射
+            // 偏移起点以防自相交 (向折射方向偏移)
+            origin = hitPoint + refractDir * 0.001f;
+            dir = refractDir;
+        } else {
+            // 全内反射 (Total Internal Reflection) -> 视为镜面反射
+            glm::vec3 reflectDir = glm::reflect(viewDir, n);
+            origin = hitPoint + reflectDir * 0.001f;
+            dir = reflectDir;
         }
+        return true;
     }
-    // -------------------------------------------------------
+    if (hitMat.type == MaterialType::SPECULAR) {
+        // 镜面反射
+        glm::vec3 reflectDir = glm::reflect(dir, normal);
+        // 偏移起点以防自相交 (向法线方向偏移)
+        origin = hitPoint + normal * 0.001f;
+        dir = reflectDir;
+        return true;
+    }
+    return false;
+}
 
+glm::vec3 RayTracer::ShadeDirect(const glm::vec3& hitPoint, const glm::vec3& normal, const glm::vec3& dir,
+                                 const glm::vec3& albedo, int hitSphereIdx, RTRandom& rng) {
     glm::vec3 viewDir = glm::normalize(-dir);
-    
-    // 3. 光照计算 (Phong Model)
+
     glm::vec3 finalColor = glm::vec3(0.0f);
 
     // 环境光 (Ambient)
@@ -277,109 +320,747 @@ glm::vec3 RayTracer::Trace(const glm::vec3& origin, const glm::vec3& dir,
     glm::vec3 ambient = ambientStrength * albedo;
     finalColor += ambient;
 
-    // 遍历所有球体寻找光源
-    for(size_t i = 0; i < spheres.size(); ++i) {
-        // 获取潜在光源的材质
-        int matIdx = spheres[i].materialIndex;
-        if (matIdx < 0 || matIdx >= materials.size()) continue;
-        
-        const RTMaterial& lightMat = materials[matIdx];
-
-        // 如果该球体发光，则视为光源
-        if (glm::length(lightMat.emission) > 0.1f) {
-             const RTSphereData& lightSphere = spheres[i];
-             
-             // 排除自己照亮自己
-             if (i == closestSphereIdx) continue;
-
-             glm::vec3 lightDir = glm::normalize(lightSphere.center - hitPoint);
-             float distToLight = glm::length(lightSphere.center - hitPoint);
-
-             // 阴影检测 (Shadow Ray)
-             bool inShadow = false;
-             for (size_t j = 0; j < spheres.size(); ++j) {
-                 if (j == closestSphereIdx || j == i) continue; // 忽略自己和光源
-                 float t;
-                 if (IntersectSphere(hitPoint + normal * 0.001f, lightDir, spheres[j], t)) {
-                     if (t < distToLight) {
-                         inShadow = true;
-                         break;
-                     }
-                 }
-             }
-
-             if (!inShadow) {
-                 // 漫反射 (Diffuse)
-                 float diff = std::max(glm::dot(normal, lightDir), 0.0f);
-                 glm::vec3 diffuse = diff * albedo * lightMat.emission * 0.5f; 
-
-                 // 镜面反射 (Specular) - Phong
-                 float specularStrength = 0.5f;
-                 float shininess = 32.0f; 
-                 glm::vec3 reflectDir = glm::reflect(-lightDir, normal);
-                 float spec = pow(std::max(glm::dot(viewDir, reflectDir), 0.0f), shininess);
-                 glm::vec3 specular = specularStrength * spec * glm::vec3(1.0f); 
-
-                 finalColor += diffuse + specular;
-             }
+    bool sampleLights;
+    int lightIterations = LightIterations(sampleLights);
+    for (int k = 0; k < lightIterations; ++k) {
+        RTShadowRay shadow;
+        if (SampleLight(k, sampleLights, hitPoint, normal, viewDir, albedo, hitSphereIdx, rng, shadow) &&
+            !Occluded(shadow)) {
+            finalColor += shadow.contribution;
         }
     }
 
     return glm::clamp(finalColor, 0.0f, 1.0f);
 }
 
+int RayTracer::LightIterations(bool& sampleLights) const {
+    // 只遍历预先建好的光源列表；光源很多时可按功率随机选取其中几个
+    int lightCount = lightList.Size();
+    sampleLights = options.lightSampleCount > 0 && options.lightSampleCount < lightCount;
+    return sampleLights ? options.lightSampleCount : lightCount;
+}
+
+bool RayTracer::SampleLight(int k, bool sampleLights, const glm::vec3& hitPoint, const glm::vec3& normal,
+                            const glm::vec3& viewDir, const glm::vec3& albedo, int hitSphereIdx,
+                            RTRandom& rng, RTShadowRay& shadow) {
+    int lightIdx = k;
+    float lightWeight = 1.0f;
+    if (sampleLights) {
+        float pdf;
+        lightIdx = lightList.Sample(rng.NextFloat(), pdf);
+        lightWeight = 1.0f / (options.lightSampleCount * pdf); // 无偏估计的权重
+    }
+    const RTLight& light = lightList.GetLights()[lightIdx];
+
+    // 排除自己照亮自己
+    if (light.sphereIndex == hitSphereIdx) return false;
+
+    // 与 glm::normalize / glm::length 的结果相同，只开一次方
+    glm::vec3 toLight = light.center - hitPoint;
+    float distToLight = RTFastSqrt(glm::dot(toLight, toLight));
+    glm::vec3 lightDir = toLight * (1.0f / distToLight);
+
+    // 阴影检测 (Shadow Ray) 的起点沿法线偏移；忽略自己和光源
+    shadow.origin = hitPoint + normal * 0.001f;
+    shadow.dir = lightDir;
+    shadow.maxT = distToLight;
+    shadow.skipA = hitSphereIdx;
+    shadow.skipB = light.sphereIndex;
+    shadow.contribution = RTShadePhong(normal, viewDir, lightDir, albedo, light.emission, options.mathPrecision) * lightWeight;
+    return true;
+}
+
+bool RayTracer::Occluded(const RTShadowRay& shadow) {
+    RTRayCounters& counters = tlsCounters;
+    ++counters.shadowRays;
+    return bvh.AnyHit(shadow.origin, shadow.dir, shadow.maxT, [&](int first, int count) {
+        ++counters.leafVisits;
+        counters.sphereTests += count;
+        return simdKernels.anyHit(sphereSoA, first, count, shadow.origin, shadow.dir, shadow.maxT,
+                                  shadow.skipA, shadow.skipB);
+    });
+}
+
 void RayTracer::Render(const std::vector<RTSphereData>& spheres, 
                       const std::vector<RTMaterial>& materials,
-                      const std::vector<RTTexture>& textures,
+                      const std::vector<RTTextureHandle>& materialTextures,
                       const glm::vec3& cameraPos, 
                       const glm::mat4& view, 
                       const glm::mat4& projection,
                       const float traceTimes) {
-    
+    // 同步到内部场景，只有变化的部分会被标记为脏
+    legacyScene.Assign(spheres, materials, materialTextures);
+    Render(legacyScene, cameraPos, view, projection, traceTimes);
+}
+
+void RayTracer::UpdateSceneData(RTScene& scene) {
+    const std::vector<RTSphereData>& spheres = scene.GetSpheres();
+    unsigned dirty = scene.GetDirtyFlags();
+    bool newScene = (&scene != lastScene);
+    lastScene = &scene;
+
+    auto bvhStart = std::chrono::high_resolution_clock::now();
+    traceTiming.bvhRebuilt = false;
+    if (newScene || (dirty & RTScene::DIRTY_TOPOLOGY) || bvh.Empty()) {
+        bvh.Build(spheres);
+        sphereSoA.Build(spheres, bvh.GetPrimIndices());
+        traceTiming.bvhRebuilt = true;
+    } else if (dirty & RTScene::DIRTY_SPHERES) {
+        // 拓扑不变时只 refit 节点包围盒，质量退化过多才重建
+        traceTiming.bvhRebuilt = bvh.Update(spheres, options.bvhRebuildThreshold);
+        if (traceTiming.bvhRebuilt) {
+            sphereSoA.Build(spheres, bvh.GetPrimIndices());
+        } else {
+            sphereSoA.Update(spheres, scene.GetDirtySpheres());
+        }
+    }
+    // 场景没有变化时直接复用上一帧的加速结构
+    std::chrono::duration<double, std::milli> bvhTime = std::chrono::high_resolution_clock::now() - bvhStart;
+    traceTiming.bvhMs = bvhTime.count();
+
+    // 光源列表：材质或拓扑变化时重建，只有球体移动时增量更新
+    if (newScene || (dirty & (RTScene::DIRTY_TOPOLOGY | RTScene::DIRTY_MATERIALS))) {
+        lightList.Build(spheres, scene.GetMaterials());
+    } else if (dirty & RTScene::DIRTY_SPHERES) {
+        lightList.Update(spheres, scene.GetMaterials(), scene.GetDirtySpheres());
+    }
+
+    scene.ClearDirty();
+}
+
+void RayTracer::Render(RTScene& scene,
+                      const glm::vec3& cameraPos,
+                      const glm::mat4& view,
+                      const glm::mat4& projection,
+                      const float traceTimes) {
+    // 等待异步工作线程空闲，并在本帧期间阻止它开始新的一帧
+    std::unique_lock<std::mutex> lock = LockAsyncIdle();
+    int slot = AcquireSlot();
+    traceTarget = frameBuffers->GetData(slot);
+    if (TraceFrame(scene, cameraPos, view, projection, traceTimes)) {
+        slotTiming[slot] = traceTiming;
+        slotStats[slot] = traceStats;
+        slotState[slot] = SLOT_PRESENTED;
+        PresentSlot(slot);
+    } else {
+        slotState[slot] = SLOT_FREE;
+        frameTiming = traceTiming;
+        frameStats = traceStats;
+    }
+}
+
+bool RayTracer::TraceFrame(RTScene& scene,
+                           const glm::vec3& cameraPos,
+                           const glm::mat4& view,
+                           const glm::mat4& projection,
+                           const float traceTimes) {
+    const std::vector<RTSphereData>& spheres = scene.GetSpheres();
+    const std::vector<RTMaterial>& materials = scene.GetMaterials();
+    const std::vector<RTTextureHandle>& materialTextures = scene.GetMaterialTextures();
+
+    auto frameStart = std::chrono::high_resolution_clock::now();
+
     // 获取逆矩阵用于从屏幕空间反推世界空间射线
     glm::mat4 invView = glm::inverse(view);
     glm::mat4 invProj = glm::inverse(projection);
+    int depth = static_cast<int>(traceTimes);
+
+    // 相机、投影或场景有任何变化都要丢弃已累加的采样
+    bool sceneChanged = (&scene != lastScene) || scene.GetDirtyFlags() != 0;
+    bool viewChanged = sceneChanged || cameraPos != lastCameraPos || view != lastView ||
+                       projection != lastProjection || depth != lastDepth;
+    if (viewChanged) {
+        ClearAccumulation();
+        lastCameraPos = cameraPos;
+        lastView = view;
+        lastProjection = projection;
+        lastDepth = depth;
+    } else if (options.progressive && options.dynamicResolution && renderScale < options.maxRenderScale) {
+        // 画面静止时回到最高分辨率再累加，收敛后的图像不受动态分辨率影响
+        ApplyRenderScale(options.maxRenderScale);
+    }
+
+    // 增量更新加速结构（最近交点与阴影查询都通过它遍历）与光源列表
+    auto updateStart = std::chrono::high_resolution_clock::now();
+    UpdateSceneData(scene);
+    std::chrono::duration<double, std::milli> updateTime = std::chrono::high_resolution_clock::now() - updateStart;
+    traceStats = RTFrameStats();
+    traceStats.sceneUpdateMs = updateTime.count();
+
+    // 主光线的屏幕分格
+    auto binStart = std::chrono::high_resolution_clock::now();
+    if (options.tileBinning) {
+        tileBins.Build(spheres, sphereSoA, cameraPos, view, invProj, renderWidth, renderHeight);
+    } else {
+        tileBins.Clear();
+    }
+    std::chrono::duration<double, std::milli> binTime = std::chrono::high_resolution_clock::now() - binStart;
+    traceStats.binningMs = binTime.count();
+
+    RTDebugView debugView = options.debugView;
+    bool progressive = options.progressive && debugView == DEBUG_VIEW_NONE;
+    if (progressive) {
+        // 已收敛：画面保持上一帧的结果，不再占用 CPU
+        if (options.progressiveMaxSamples > 0 && accumulatedSamples >= options.progressiveMaxSamples) {
+            traceTiming.frameMs = 0.0;
+            traceTiming.busyMs = 0.0;
+            traceTiming.rays = 0;
+            traceTiming.accumulatedSamples = accumulatedSamples;
+            traceStats.frameMs = 0.0;
+            return false;
+        }
+        if (accumulatedSamples == 0) accumBuffer.assign(renderWidth * renderHeight, glm::vec3(0.0f));
+        ++accumulatedSamples;
+    } else {
+        accumulatedSamples = 0;
+    }
+    ++frameIndex;
+    frameDepth = depth;
+    // 相邻像素主光线的夹角：观察空间中 y 斜率对 NDC 的导数 * 每像素的 NDC 跨度
+    pixelSpreadAngle = std::atan(std::fabs(invProj[1][1]) * 2.0f / renderHeight);
+
+    // 每个线程各自累计追踪耗时与计数，帧末汇总
+    frameUseOpenMP = (options.scheduler == SCHEDULER_OPENMP);
+#ifdef _OPENMP
+    int threads = frameUseOpenMP ? (options.threadCount > 0 ? options.threadCount : omp_get_max_threads())
+                                 : tileScheduler.GetThreadCount();
+#else
+    frameUseOpenMP = false; // 未启用 OpenMP 编译，使用内置线程池
+    int threads = tileScheduler.GetThreadCount();
+#endif
+    threadBusyMs.assign(threads, 0.0);
+    threadCounters.assign(threads, RTRayCounters());
+    auto traceStart = std::chrono::high_resolution_clock::now();
+
+    // 调试视图下逐像素记录耗时 / 求交测试数 / 最深递归层，分块耗时在分块结束时整块写入
+    bool perPixelDebug = debugView != DEBUG_VIEW_NONE && debugView != DEBUG_VIEW_TILE_TIME;
+    if (debugView != DEBUG_VIEW_NONE) debugBuffer.assign(renderWidth * renderHeight, 0.0f);
+    auto renderPixel = [&](int x, int y) {
+        if (!perPixelDebug) {
+            RenderPixel(x, y, spheres, materials, materialTextures, cameraPos, invView, invProj, depth);
+            return;
+        }
+        auto pixelStart = std::chrono::high_resolution_clock::now();
+        uint64_t testsBefore = tlsCounters.sphereTests;
+        tlsPixelMaxLevel = 0;
+        RenderPixel(x, y, spheres, materials, materialTextures, cameraPos, invView, invProj, depth);
+        float value = static_cast<float>(tlsPixelMaxLevel);
+        if (debugView == DEBUG_VIEW_PIXEL_TIME) {
+            std::chrono::duration<double, std::micro> pixelTime = std::chrono::high_resolution_clock::now() - pixelStart;
+            value = static_cast<float>(pixelTime.count());
+        } else if (debugView == DEBUG_VIEW_SPHERE_TESTS) {
+            value = static_cast<float>(tlsCounters.sphereTests - testsBefore);
+        }
+        debugBuffer[y * renderWidth + x] = value;
+    };
+    // 一块区域：可用主光线包时按包追踪，否则逐像素
+    int packetSize = perPixelDebug ? 0 : options.packetSize;
+    auto renderRegion = [&](int x0, int y0, int x1, int y1) {
+        if (packetSize > 1) {
+            for (int py = y0; py < y1; py += packetSize) {
+                for (int px = x0; px < x1; px += packetSize) {
+                    RenderPacket(px, py, std::min(px + packetSize, x1), std::min(py + packetSize, y1),
+                                 spheres, materials, materialTextures, cameraPos, invView, invProj, depth);
+                }
+            }
+            return;
+        }
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                renderPixel(x, y);
+            }
+        }
+    };
+
+    if (options.engine == ENGINE_WAVEFRONT && debugView == DEBUG_VIEW_NONE) {
+        TraceWavefront(spheres, materials, materialTextures, cameraPos, invView, invProj, depth);
+    } else if (frameUseOpenMP) {
+#ifdef _OPENMP
+        // 按行调度；使用主光线包时每个任务为包高度的一条横带
+        int rows = std::max(packetSize, 1);
+        int bands = (renderHeight + rows - 1) / rows;
+        #pragma omp parallel for schedule(dynamic) num_threads(threads)
+        for (int band = 0; band < bands; ++band) {
+            int y0 = band * rows, y1 = std::min(y0 + rows, renderHeight);
+            auto rowStart = std::chrono::high_resolution_clock::now();
+            tlsCounters = RTRayCounters();
+            renderRegion(0, y0, renderWidth, y1);
+            std::chrono::duration<double, std::milli> rowTime = std::chrono::high_resolution_clock::now() - rowStart;
+            if (debugView == DEBUG_VIEW_TILE_TIME) {
+                std::fill(debugBuffer.begin() + y0 * renderWidth, debugBuffer.begin() + y1 * renderWidth,
+                          static_cast<float>(rowTime.count() * 1000.0));
+            }
+            threadBusyMs[omp_get_thread_num()] += rowTime.count();
+            threadCounters[omp_get_thread_num()].Add(tlsCounters);
+        }
+#endif
+    } else {
+        tileScheduler.Run(renderWidth, renderHeight, options.tileSize, [&](const RTTile& tile, int threadIndex) {
+            auto tileStart = std::chrono::high_resolution_clock::now();
+            tlsCounters = RTRayCounters();
+            renderRegion(tile.x0, tile.y0, tile.x1, tile.y1);
+            std::chrono::duration<double, std::milli> tileTime = std::chrono::high_resolution_clock::now() - tileStart;
+            if (debugView == DEBUG_VIEW_TILE_TIME) {
+                for (int y = tile.y0; y < tile.y1; ++y) {
+                    std::fill_n(&debugBuffer[y * renderWidth + tile.x0], tile.x1 - tile.x0,
+                                static_cast<float>(tileTime.count() * 1000.0));
+                }
+            }
+            threadBusyMs[threadIndex] += tileTime.count();
+            threadCounters[threadIndex].Add(tlsCounters);
+        });
+    }
+
+    if (debugView != DEBUG_VIEW_NONE) traceStats.debugScaleMax = WriteDebugHeatmap(debugView);
+
+    auto traceEnd = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> traceTime = traceEnd - traceStart;
+    std::chrono::duration<double, std::milli> frameTime = traceEnd - frameStart;
+    traceTiming.frameMs = frameTime.count();
+    traceTiming.threads = static_cast<int>(threadBusyMs.size());
+    traceTiming.busyMs = 0.0;
+    for (double ms : threadBusyMs) traceTiming.busyMs += ms;
+    for (const RTRayCounters& counters : threadCounters) traceStats.counters.Add(counters);
+    traceTiming.rays = traceStats.counters.TotalRays();
+    traceStats.traceMs = traceTime.count();
+    traceStats.frameMs = traceTiming.frameMs;
+    traceTiming.accumulatedSamples = progressive ? accumulatedSamples : 1;
+    traceTiming.renderScale = renderScale;
+    traceTiming.renderWidth = renderWidth;
+    traceTiming.renderHeight = renderHeight;
+    traceStats.renderWidth = renderWidth;
+    traceStats.renderHeight = renderHeight;
+
+    // 决定下一帧的追踪分辨率（渐进模式下画面静止时保持最高分辨率）
+    if (!progressive || viewChanged) UpdateDynamicResolution(traceTiming.frameMs);
+    return true;
+}
+
+void RayTracer::ParallelFor(int count, int chunkSize, const std::function<void(int, int)>& fn) {
+    auto runChunk = [&](int begin, int end, int threadIndex) {
+        auto chunkStart = std::chrono::high_resolution_clock::now();
+        tlsCounters = RTRayCounters();
+        fn(begin, end);
+        std::chrono::duration<double, std::milli> chunkTime = std::chrono::high_resolution_clock::now() - chunkStart;
+        threadBusyMs[threadIndex] += chunkTime.count();
+        threadCounters[threadIndex].Add(tlsCounters);
+    };
+    if (frameUseOpenMP) {
+#ifdef _OPENMP
+        int chunks = (count + chunkSize - 1) / chunkSize;
+        #pragma omp parallel for schedule(dynamic) num_threads(static_cast<int>(threadBusyMs.size()))
+        for (int c = 0; c < chunks; ++c) {
+            runChunk(c * chunkSize, std::min(count, (c + 1) * chunkSize), omp_get_thread_num());
+        }
+#endif
+    } else {
+        // 一维区间看作高为 1 的图像，每个分块即一段 [x0, x1)
+        tileScheduler.Run(count, 1, chunkSize, [&](const RTTile& tile, int threadIndex) {
+            runChunk(tile.x0, tile.x1, threadIndex);
+        });
+    }
+}
+
+RTRayCounters& RayTracer::ThreadCounters() {
+    return tlsCounters;
+}
+
+double RayTracer::WriteDebugHeatmap(RTDebugView view) {
+    // 递归层使用固定范围；耗时与测试次数取 99 百分位作为上限，避免个别异常值压暗整幅图
+    double scaleMax = frameDepth;
+    if (view != DEBUG_VIEW_DEPTH) {
+        std::vector<float> sorted = debugBuffer;
+        size_t k = sorted.size() * 99 / 100;
+        std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+        scaleMax = sorted[k];
+    }
+    if (scaleMax <= 0.0) scaleMax = 1.0;
+
+    static const glm::vec3 gradient[] = {
+        glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 1.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f),
+        glm::vec3(1.0f, 1.0f, 1.0f)
+    };
+    const int segments = static_cast<int>(sizeof(gradient) / sizeof(gradient[0])) - 1;
+    for (size_t i = 0; i < debugBuffer.size(); ++i) {
+        float t = glm::clamp(static_cast<float>(debugBuffer[i] / scaleMax), 0.0f, 1.0f) * segments;
+        int segment = std::min(static_cast<int>(t), segments - 1);
+        glm::vec3 color = glm::mix(gradient[segment], gradient[segment + 1], t - segment);
+        traceTarget[i * 3] = static_cast<unsigned char>(color.r * 255);
+        traceTarget[i * 3 + 1] = static_cast<unsigned char>(color.g * 255);
+        traceTarget[i * 3 + 2] = static_cast<unsigned char>(color.b * 255);
+    }
+    return scaleMax;
+}
+
+void RayTracer::PresentSlot(int slot) {
+    // 交给显示端（例如 RTPresenter 上传到纹理）
+    const RTFrameTiming& timing = slotTiming[slot];
+    auto presentStart = std::chrono::high_resolution_clock::now();
+    frameBuffers->Present(slot, timing.renderWidth, timing.renderHeight);
+    std::chrono::duration<double, std::milli> presentTime = std::chrono::high_resolution_clock::now() - presentStart;
+    frameTiming = timing;
+    frameStats = slotStats[slot];
+    frameStats.presentMs = presentTime.count();
+    presentedSlot = slot;
+}
+
+void RayTracer::ReclaimSlots() {
+    for (int i = 0; i < RTFrameBuffers::SlotCount; ++i) {
+        if (slotState[i] == SLOT_PRESENTED && frameBuffers->IsSlotIdle(i)) slotState[i] = SLOT_FREE;
+    }
+}
+
+int RayTracer::FindFreeSlot() const {
+    for (int i = 0; i < RTFrameBuffers::SlotCount; ++i) {
+        if (slotState[i] == SLOT_FREE) return i;
+    }
+    return -1;
+}
+
+int RayTracer::AcquireSlot() {
+    ReclaimSlots();
+    int slot = FindFreeSlot();
+    if (slot < 0 && readySlot >= 0) {
+        // 异步模式还没显示的帧直接丢弃
+        slot = readySlot;
+        readySlot = -1;
+    }
+    if (slot < 0) {
+        // 工作线程空闲时不会有缓冲处于追踪中，只能是显示端还在使用，等待其中一个
+        for (int i = 0; i < RTFrameBuffers::SlotCount && slot < 0; ++i) {
+            if (slotState[i] == SLOT_PRESENTED) {
+                frameBuffers->WaitSlotIdle(i);
+                slot = i;
+            }
+        }
+    }
+    slotState[slot] = SLOT_TRACING;
+    return slot;
+}
+
+void RayTracer::SubmitFrame(RTScene& scene,
+                            const glm::vec3& cameraPos,
+                            const glm::mat4& view,
+                            const glm::mat4& projection,
+                            const float traceTimes) {
+    if (!asyncThread.joinable()) {
+        asyncStop = false;
+        asyncThread = std::thread(&RayTracer::AsyncWorkerLoop, this);
+    }
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        ReclaimSlots(); // 显示端已用完的缓冲交还给工作线程
+
+        // 场景没有变化时不必再拷贝
+        if (&scene != lastSubmittedScene || scene.GetDirtyFlags() != 0) {
+            submitSpheres = scene.GetSpheres();
+            submitMaterials = scene.GetMaterials();
+            submitMaterialTextures = scene.GetMaterialTextures();
+            submitSceneChanged = true;
+            lastSubmittedScene = &scene;
+            scene.ClearDirty();
+        }
+        // 工作线程还没取走的旧提交直接被覆盖，只追踪最新的相机
+        submitCameraPos = cameraPos;
+        submitView = view;
+        submitProjection = projection;
+        submitTraceTimes = traceTimes;
+        hasSubmit = true;
+    }
+    asyncCv.notify_one();
+}
+
+bool RayTracer::TryGetLatestFrame() {
+    int slot;
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        ReclaimSlots();
+        slot = readySlot;
+        if (slot >= 0) {
+            readySlot = -1;
+            slotState[slot] = SLOT_PRESENTED; // 显示期间工作线程不会选中它
+        }
+    }
+    asyncCv.notify_one(); // 可能有缓冲被回收，工作线程可以继续
+    if (slot < 0) return false;
+
+    // 显示（上传）在锁外进行，工作线程可以同时写入下一帧
+    PresentSlot(slot);
+    return true;
+}
+
+void RayTracer::AsyncWorkerLoop() {
+    std::unique_lock<std::mutex> lock(asyncMutex);
+    while (true) {
+        // 需要有新的提交，并且有显示端已经用完的空闲缓冲
+        asyncCv.wait(lock, [this] { return asyncStop || (hasSubmit && FindFreeSlot() >= 0); });
+        if (asyncStop) break;
+        int slot = FindFreeSlot();
+        slotState[slot] = SLOT_TRACING;
+        traceTarget = frameBuffers->GetData(slot);
+
+        // 取出最新的提交
+        if (submitSceneChanged) {
+            asyncScene.Assign(submitSpheres, submitMaterials, submitMaterialTextures);
+            submitSceneChanged = false;
+        }
+        glm::vec3 cameraPos = submitCameraPos;
+        glm::mat4 view = submitView;
+        glm::mat4 projection = submitProjection;
+        float traceTimes = submitTraceTimes;
+        hasSubmit = false;
+        asyncBusy = true;
+        lock.unlock();
+
+        bool traced = TraceFrame(asyncScene, cameraPos, view, projection, traceTimes);
 
-    // 简单的单线程循环
-    // 这里可以换成GPU计算，比如使用CUDA
-    // CPU计算多个矩阵速度会很慢
-    #pragma omp parallel for schedule(dynamic)
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            // 归一化设备坐标 (NDC)
-            float ndcX = (2.0f * x) / width - 1.0f;
-            float ndcY = 1.0f - (2.0f * y) / height; // 注意 Y 轴翻转
-
-            // 裁剪空间 -> 观察空间 -> 世界空间
-            glm::vec4 clipCoords(ndcX, ndcY, -1.0f, 1.0f);
-            glm::vec4 eyeCoords = invProj * clipCoords;
-            eyeCoords = glm::vec4(eyeCoords.x, eyeCoords.y, -1.0f, 0.0f); 
-            glm::vec4 worldCoords = invView * eyeCoords;
-            glm::vec3 rayDir = glm::normalize(glm::vec3(worldCoords));
-
-            glm::vec3 color = Trace(cameraPos, rayDir, spheres, materials, textures, traceTimes);
-
-            // 写入像素缓冲
-            int index = (y * width + x) * 3;
-            pixelBuffer[index] = static_cast<unsigned char>(color.r * 255);
-            pixelBuffer[index + 1] = static_cast<unsigned char>(color.g * 255);
-            pixelBuffer[index + 2] = static_cast<unsigned char>(color.b * 255);
+        lock.lock();
+        if (traced) {
+            // 主线程还没取走的上一帧直接作废，只保留最新的一帧
+            if (readySlot >= 0) slotState[readySlot] = SLOT_FREE;
+            readySlot = slot;
+            slotState[slot] = SLOT_READY;
+            slotTiming[slot] = traceTiming;
+            slotStats[slot] = traceStats;
+        } else {
+            slotState[slot] = SLOT_FREE;
         }
+        asyncBusy = false;
+        idleCv.notify_all();
+    }
+}
+
+std::unique_lock<std::mutex> RayTracer::LockAsyncIdle() {
+    std::unique_lock<std::mutex> lock(asyncMutex);
+    idleCv.wait(lock, [this] { return !asyncBusy; });
+    return lock;
+}
+
+void RayTracer::StopAsync() {
+    if (!asyncThread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        asyncStop = true;
+    }
+    asyncCv.notify_one();
+    asyncThread.join();
+}
+
+void RayTracer::RenderPixel(int x, int y,
+                            const std::vector<RTSphereData>& spheres,
+                            const std::vector<RTMaterial>& materials,
+                            const std::vector<RTTextureHandle>& materialTextures,
+                            const glm::vec3& cameraPos,
+                            const glm::mat4& invView,
+                            const glm::mat4& invProj,
+                            int depth) {
+    RTRandom rng = PixelRandom(x, y);
+    glm::vec3 rayDir = PrimaryRayDir(x, y, invView, invProj, rng);
+    RTRayHit hit;
+    bool binned = BinnedPrimaryHit(x, y, cameraPos, rayDir, hit);
+    glm::vec3 color = Trace(cameraPos, rayDir, spheres, materials, materialTextures, depth, rng, binned ? &hit : nullptr);
+    WritePixel(x, y, color);
+}
+
+bool RayTracer::BinnedPrimaryHit(int x, int y, const glm::vec3& origin, const glm::vec3& dir, RTRayHit& hit) {
+    if (!tileBins.Valid()) return false;
+    int count;
+    const int* candidates = tileBins.PixelSpheres(x, y, count);
+    hit.sphere = -1;
+    hit.t = std::numeric_limits<float>::max();
+    if (count == 0) return true; // 空格子：直接采样环境
+
+    RTRayPacket packet;
+    packet.origin = origin;
+    packet.count = 1;
+    packet.Set(0, dir, hit.t, hit.sphere);
+    packet.Pad();
+    simdKernels.packetClosestHit(sphereSoA, candidates, count, packet);
+    tlsCounters.sphereTests += count;
+    hit.sphere = packet.hitSphere[0];
+    hit.t = packet.tMax[0];
+    return true;
+}
+
+void RayTracer::RenderPacket(int x0, int y0, int x1, int y1,
+                             const std::vector<RTSphereData>& spheres,
+                             const std::vector<RTMaterial>& materials,
+                             const std::vector<RTTextureHandle>& materialTextures,
+                             const glm::vec3& cameraPos,
+                             const glm::mat4& invView,
+                             const glm::mat4& invProj,
+                             int depth) {
+    RTRayCounters& counters = tlsCounters;
+    const int packetWidth = x1 - x0;
+    RTRayPacket packet;
+    packet.origin = cameraPos;
+    packet.count = packetWidth * (y1 - y0);
+    uint32_t rngState[RTRayPacket::MaxRays]; // 生成方向后各像素随机序列的位置，着色时继续使用
+
+    for (int i = 0; i < packet.count; ++i) {
+        RTRandom rng = PixelRandom(x0 + i % packetWidth, y0 + i / packetWidth);
+        packet.Set(i, PrimaryRayDir(x0 + i % packetWidth, y0 + i / packetWidth, invView, invProj, rng),
+                   std::numeric_limits<float>::max(), -1);
+        rngState[i] = rng.state;
+    }
+    packet.Pad();
+
+    // 视锥取包内像素的完整范围（渐进模式的抖动不超过半个像素），四条棱经过四个角
+    float left = x0 - 0.5f, right = x1 - 0.5f, top = y0 - 0.5f, bottom = y1 - 0.5f;
+    glm::vec3 edges[4] = {ScreenRayDir(left, top, invView, invProj), ScreenRayDir(right, top, invView, invProj),
+                          ScreenRayDir(right, bottom, invView, invProj), ScreenRayDir(left, bottom, invView, invProj)};
+    RTFrustum frustum;
+    frustum.Build(cameraPos, edges);
+
+    // 视锥外的球体对整个包只剔除一次：有屏幕分格时从所覆盖格子的球体中筛选，否则遍历 BVH
+    std::vector<int>& candidates = tlsPacketCandidates;
+    if (tileBins.Valid()) {
+        tileBins.Gather(x0, y0, x1, y1, candidates);
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](int i) {
+            const RTSphereData& sphere = spheres[sphereSoA.sphereIndex[i]];
+            return !frustum.IntersectsSphere(sphere.center, sphere.radius);
+        }), candidates.end());
+    } else {
+        candidates.clear();
+        bvh.FrustumQuery(frustum, [&](int first, int count) {
+            ++counters.leafVisits;
+            for (int i = first; i < first + count; ++i) {
+                const RTSphereData& sphere = spheres[sphereSoA.sphereIndex[i]];
+                if (frustum.IntersectsSphere(sphere.center, sphere.radius)) candidates.push_back(i);
+            }
+        });
+    }
+    counters.sphereTests += static_cast<uint64_t>(candidates.size()) * packet.count;
+    if (!candidates.empty()) {
+        simdKernels.packetClosestHit(sphereSoA, candidates.data(), static_cast<int>(candidates.size()), packet);
+    }
+
+    for (int i = 0; i < packet.count; ++i) {
+        RTRandom rng(0);
+        rng.state = rngState[i];
+        glm::vec3 dir(packet.dirX[i], packet.dirY[i], packet.dirZ[i]);
+        RTRayHit hit{packet.hitSphere[i], packet.tMax[i]};
+        glm::vec3 color = Trace(cameraPos, dir, spheres, materials, materialTextures, depth, rng, &hit);
+        WritePixel(x0 + i % packetWidth, y0 + i / packetWidth, color);
+    }
+}
+
+RTRandom RayTracer::PixelRandom(int x, int y) const {
+    // 每个像素、每帧独立的随机序列
+    return RTRandom(RTRandom::Hash(static_cast<uint32_t>(y * renderWidth + x)) ^ RTRandom::Hash(frameIndex));
+}
+
+glm::vec3 RayTracer::PrimaryRayDir(int x, int y, const glm::mat4& invView, const glm::mat4& invProj, RTRandom& rng) const {
+    // 渐进模式的第一个采样与普通模式相同，之后在像素范围 [-0.5, 0.5) 内抖动（盒式滤波抗锯齿）
+    float px = static_cast<float>(x);
+    float py = static_cast<float>(y);
+    if (accumulatedSamples > 1) {
+        px += rng.NextFloat() - 0.5f;
+        py += rng.NextFloat() - 0.5f;
     }
 
-    // 更新纹理
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixelBuffer.data());
+    return glm::normalize(ScreenRayDir(px, py, invView, invProj));
+}
+
+glm::vec3 RayTracer::ScreenRayDir(float px, float py, const glm::mat4& invView, const glm::mat4& invProj) const {
+    // 归一化设备坐标 (NDC)
+    float ndcX = (2.0f * px) / renderWidth - 1.0f;
+    float ndcY = 1.0f - (2.0f * py) / renderHeight; // 注意 Y 轴翻转
+
+    // 裁剪空间 -> 观察空间 -> 世界空间
+    glm::vec4 clipCoords(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 eyeCoords = invProj * clipCoords;
+    eyeCoords = glm::vec4(eyeCoords.x, eyeCoords.y, -1.0f, 0.0f); 
+    glm::vec4 worldCoords = invView * eyeCoords;
+    return glm::vec3(worldCoords);
+}
+
+void RayTracer::WritePixel(int x, int y, glm::vec3 color) {
+    if (accumulatedSamples > 0) { // 本帧渐进累加（调试视图下关闭）
+        glm::vec3& sum = accumBuffer[y * renderWidth + x];
+        sum += color;
+        color = sum / static_cast<float>(accumulatedSamples);
+    }
+
+    // 写入像素缓冲（自发光颜色可能超过 1）
+    color = glm::clamp(color, 0.0f, 1.0f);
+    int index = (y * renderWidth + x) * 3;
+    traceTarget[index] = static_cast<unsigned char>(color.r * 255);
+    traceTarget[index + 1] = static_cast<unsigned char>(color.g * 255);
+    traceTarget[index + 2] = static_cast<unsigned char>(color.b * 255);
+}
+
+RTTextureHandle RayTracer::RegisterTexture(const RTTexture& tex) {
+    std::unique_lock<std::mutex> lock = LockAsyncIdle();
+    textureRegistry.push_back(tex);
+    mipRegistry.emplace_back();
+    mipRegistry.back().Build(textureRegistry.back(), options.textureLayout);
+    return static_cast<RTTextureHandle>(textureRegistry.size() - 1);
 }
 
-void RayTracer::SetEnvironmentTexture(const RTTexture& env) {
-    environmentTexture = env;
+RTTextureHandle RayTracer::RegisterTexture(RTTexture&& tex) {
+    std::unique_lock<std::mutex> lock = LockAsyncIdle();
+    textureRegistry.push_back(std::move(tex));
+    mipRegistry.emplace_back();
+    mipRegistry.back().Build(textureRegistry.back(), options.textureLayout);
+    return static_cast<RTTextureHandle>(textureRegistry.size() - 1);
+}
+
+void RayTracer::ReleaseTexture(RTTextureHandle handle) {
+    std::unique_lock<std::mutex> lock = LockAsyncIdle();
+    if (handle < 0 || handle >= static_cast<int>(textureRegistry.size())) return;
+    // 句柄不复用，只释放像素数据
+    RTTexture& tex = textureRegistry[handle];
+    tex.width = tex.height = tex.channels = 0;
+    std::vector<unsigned char>().swap(tex.data);
+    mipRegistry[handle] = RTMipTexture();
+    ClearAccumulation();
+}
+
+const RTTexture* RayTracer::GetTexture(RTTextureHandle handle) const {
+    if (handle < 0 || handle >= static_cast<int>(textureRegistry.size())) return nullptr;
+    return &textureRegistry[handle];
+}
+
+void RayTracer::SetEnvironmentTexture(const RTTexture& env, bool toCubemap, int faceSize) {
+    std::unique_lock<std::mutex> lock = LockAsyncIdle();
     hasEnvironmentTexture = (env.width > 0 && env.height > 0 && !env.data.empty());
+    environmentCube.Clear();
+    if (hasEnvironmentTexture && toCubemap) {
+        // 转换后不再需要原图，只保留立方体贴图
+        RTMipTexture equirect;
+        equirect.Build(env);
+        environmentCube.BuildFromEquirect(equirect, faceSize, options.textureLayout);
+        environmentTexture = RTTexture();
+        environmentMip.Clear();
+    } else {
+        environmentTexture = env;
+        environmentMip.Build(environmentTexture, options.textureLayout);
+    }
+    ClearAccumulation();
+}
+
+bool RayTracer::SetEnvironmentCubemap(const std::vector<RTTexture>& faces) {
+    std::unique_lock<std::mutex> lock = LockAsyncIdle();
+    RTCubemap cube;
+    if (!cube.BuildFromFaces(faces, options.textureLayout)) return false;
+    environmentCube = std::move(cube);
+    environmentTexture = RTTexture();
+    environmentMip.Clear();
+    hasEnvironmentTexture = true;
+    ClearAccumulation();
+    return true;
+}
+
+const unsigned char* RayTracer::GetPixels() const {
+    return presentedSlot >= 0 ? frameBuffers->GetData(presentedSlot) : nullptr;
 }
 
-void RayTracer::DrawResult() {
-    glUseProgram(screenShaderProgram);
-    glBindVertexArray(quadVAO);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+bool RayTracer::GetAccumulatedImage(std::vector<glm::vec3>& out) const {
+    if (!options.progressive || accumulatedSamples <= 0) return false;
+    out.resize(accumBuffer.size());
+    float inv = 1.0f / accumulatedSamples;
+    for (size_t i = 0; i < accumBuffer.size(); ++i) out[i] = accumBuffer[i] * inv;
+    return true;
 }
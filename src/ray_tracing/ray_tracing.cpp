@@ -1,11 +1,13 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <cstdio>
 #include "CommonGL.h"
 #include "Unified_CubeClass.h"
 #include "Unified_SphereClass.h"
 #include <glm.hpp>
 #include "RayTracer.h" // 引入 CPU 光线追踪器
+#include "RTPresenter.h" // 追踪结果的 OpenGL 显示
 #include "RayTracingData.h"
 
 int main()
@@ -14,8 +16,22 @@ int main()
     float height = 1080.0f * scale_screen;
     GLFWwindow* window = Initialize_OpenGL(weidth, height); // 初始化OpenGL（创建窗口，设置上下文等）
     
-    // 初始化 CPU 光线追踪器
+    // 初始化 CPU 光线追踪器；追踪结果直接写入显示端的 PBO（presenter 须比 rayTracer 后析构）
+    RTPresenter presenter(weidth, height);
     RayTracer rayTracer(weidth, height);
+    rayTracer.SetFrameBuffers(&presenter);
+    RTRenderOptions rtOptions;
+    rtOptions.scheduler = SCHEDULER_TILE_POOL; // 或 SCHEDULER_OPENMP
+    rtOptions.threadCount = 0;                 // 0: 使用全部硬件线程
+    rtOptions.tileSize = 16;
+    rtOptions.progressive = true;              // 画面静止时逐帧累加采样
+    rtOptions.progressiveMaxSamples = 64;
+    rtOptions.dynamicResolution = true;        // 移动相机时降低追踪分辨率以保持帧率
+    rtOptions.targetFrameMs = 16.0f;
+    rayTracer.SetOptions(rtOptions);
+    float lastReportTime = 0.0f; // 上次输出追踪耗时的时间
+    std::pair<bool, bool> Key_V = {false, false}; // 键盘 V 切换调试视图（热力图）
+    std::pair<bool, bool> Key_B = {false, false}; // 键盘 B 切换深度优先 / wavefront 追踪
 
     Unified_SphereClass SUN("material/Tshader.vs", "material/Tshader.fs", "material/sun.jpg",8,8,2.0f);
     Unified_SphereClass EARTH("material/Tshader.vs", "material/Tshader.fs","material/earth.png",8,8,0.6f,0.6f);
@@ -24,7 +40,7 @@ int main()
 
     RTTexture skyTexture;
     sky.GetTextureData(skyTexture.width, skyTexture.height, skyTexture.channels, skyTexture.data);
-    rayTracer.SetEnvironmentTexture(skyTexture);
+    rayTracer.SetEnvironmentTexture(skyTexture, true); // 启动时转换为立方体贴图，天空像素不再计算 atan2 / asin
 
     // 设置光追材质
     // glm::vec3 color, glm::vec3 emission, int type, float roughness = 0.0f, float ior = 1.45f
@@ -36,6 +52,23 @@ int main()
     EARTH.SetRTMaterial(glm::vec3(0.0f,0.0f,0.0f), glm::vec3(0.0f), MaterialType::SPECULAR, 0.0f, 1.45f); 
     MOON.SetRTMaterial(glm::vec3(0.7f, 0.7f, 0.7f), glm::vec3(0.0f), MaterialType::DIFFUSE);
 
+    // 贴图只在启动时注册一次，之后每帧按句柄引用
+    auto RegisterObjectTexture = [&](Unified_SphereClass& obj) {
+        RTTexture tex;
+        obj.GetTextureData(tex.width, tex.height, tex.channels, tex.data);
+        return rayTracer.RegisterTexture(std::move(tex));
+    };
+    // 持久化的光追场景：对象只添加一次，每帧只更新发生变化的球心/半径
+    RTScene rtScene;
+    auto AddObject = [&](Unified_SphereClass& obj) {
+        RTMaterialHandle material = rtScene.AddMaterial(obj.GetRTMaterial(), RegisterObjectTexture(obj));
+        RTSphereData data = obj.GetRTData();
+        return rtScene.AddSphere(data.center, data.radius, material);
+    };
+    RTSphereHandle sunHandle = AddObject(SUN);
+    RTSphereHandle earthHandle = AddObject(EARTH);
+    RTSphereHandle moonHandle = AddObject(MOON);
+
     // TODO
     while (!glfwWindowShouldClose(window)) // 主渲染循环
     {
@@ -50,6 +83,21 @@ int main()
         processInput(window);
         StateSwitch(window);
 
+        // V：正常画面 -> 像素耗时 -> 分块耗时 -> 求交测试数 -> 递归深度 -> 正常画面
+        Key_V.second = glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS;
+        if (Key_V.second && !Key_V.first) {
+            rtOptions.debugView = static_cast<RTDebugView>((rtOptions.debugView + 1) % (DEBUG_VIEW_DEPTH + 1));
+            rayTracer.SetOptions(rtOptions);
+        }
+        Key_V.first = Key_V.second;
+
+        Key_B.second = glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS;
+        if (Key_B.second && !Key_B.first) {
+            rtOptions.engine = rtOptions.engine == ENGINE_WAVEFRONT ? ENGINE_DEPTH_FIRST : ENGINE_WAVEFRONT;
+            rayTracer.SetOptions(rtOptions);
+        }
+        Key_B.first = Key_B.second;
+
         // SUN ROTATE
         glm::mat4 tmp0 = glm::mat4(1.0f);
         tmp0 = glm::rotate(tmp0, glm::radians(90.0f), glm::vec3(1.0f, .0f, 0.0f));
@@ -86,41 +134,48 @@ int main()
         EARTH.SetModelMatrix(tmp1);
         MOON.SetModelMatrix(tmp2);
 
-        // 收集光追数据
-        std::vector<RTSphereData> spheres;
-        std::vector<RTMaterial> materials;
-        std::vector<RTTexture> textures; // 新增纹理列表
-
-        // 辅助 lambda：添加对象到列表
-        auto AddObject = [&](Unified_SphereClass& obj, int matIndex) {
+        // 同步光追场景（未变化的对象不会被标记为脏）
+        auto UpdateObject = [&](Unified_SphereClass& obj, RTSphereHandle handle) {
             RTSphereData data = obj.GetRTData();
-            data.materialIndex = matIndex;
-            spheres.push_back(data);
-            // 提取材质数据
-            materials.push_back(obj.GetRTMaterial());
-            
-            // 提取贴图数据
-            RTTexture tex;
-            obj.GetTextureData(tex.width, tex.height, tex.channels, tex.data);
-            textures.push_back(tex);
+            rtScene.UpdateSphere(handle, data.center, data.radius);
         };
-
-        // 太阳 (Index 0)
-        AddObject(SUN, 0);
-        // 地球 (Index 1)
-        AddObject(EARTH, 1);
-        // 月球 (Index 2)
-        AddObject(MOON, 2);
-        // // 天空球 (Index 3)
+        UpdateObject(SUN, sunHandle);
+        UpdateObject(EARTH, earthHandle);
+        UpdateObject(MOON, moonHandle);
 
         // 执行 CPU 光线追踪渲染
         glm::mat4 view = camera.GetViewMatrix();
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), weidth / height, 0.1f, 100.0f);
         
-        rayTracer.Render(spheres, materials, textures, camera.Position, view, projection, 5);
+        // 异步追踪：提交后立即返回，相机输入与画面刷新不受追踪耗时影响
+        rayTracer.SubmitFrame(rtScene, camera.Position, view, projection, 5);
+        bool newFrame = rayTracer.TryGetLatestFrame(); // 有新完成的帧时上传到纹理
+
+        // 每秒输出一次追踪耗时与线程利用率
+        if (newFrame && currentFrame - lastReportTime > 1.0f) {
+            const RTFrameTiming& timing = rayTracer.GetFrameTiming();
+            std::cout << "[RayTracer] " << timing.frameMs << " ms/frame, " << timing.threads << " threads, busy/wall "
+                      << timing.Parallelism() << " (" << timing.Utilization() * 100.0 << "% utilization), "
+                      << timing.renderWidth << "x" << timing.renderHeight << std::endl;
+
+            // 窗口标题作为统计信息的叠加显示：各阶段耗时与光线计数
+            const RTFrameStats& stats = rayTracer.GetFrameStats();
+            const RTRayCounters& c = stats.counters;
+            double rays = static_cast<double>(c.TotalRays());
+            char title[256];
+            std::snprintf(title, sizeof(title),
+                          "OpenGL World | %s | %.1f ms (scene %.2f, trace %.1f, upload %.2f) | %.2f Mrays/s | "
+                          "primary %.2fM secondary %.2fM shadow %.2fM | %.1f tests/ray",
+                          rtOptions.engine == ENGINE_WAVEFRONT ? "wavefront" : "depth-first",
+                          stats.frameMs, stats.sceneUpdateMs, stats.traceMs, stats.presentMs,
+                          stats.RaysPerSecond() / 1e6, c.primaryRays / 1e6, c.secondaryRays / 1e6,
+                          c.shadowRays / 1e6, rays > 0.0 ? c.sphereTests / rays : 0.0);
+            glfwSetWindowTitle(window, title);
+            lastReportTime = currentFrame;
+        }
         
         // 绘制结果到屏幕
-        rayTracer.DrawResult();
+        presenter.Draw();
 
         glfwSwapBuffers(window); // 双循环显像
         glfwPollEvents(); // 检查调用事件
@@ -0,0 +1,430 @@
+// 场景级基准：程序化生成的确定性场景（3 ~ 100k 个球体），测量每帧耗时分位数、
+// 主光线 / 总光线吞吐量以及 1..N 线程的加速比，结果同时输出为 JSON 以便长期跟踪
+// 用法见 PrintUsage
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <glm.hpp>
+#include <gtc/matrix_transform.hpp>
+#include "RayTracer.h"
+
+struct BenchOptions {
+    int width = 640;
+    int height = 360;
+    int depth = 5;
+    int warmupFrames = 2;
+    int frames = 10;
+    int maxThreads = 0;               // 0 表示全部硬件线程
+    bool scaling = true;              // false 时只测最大线程数
+    RTTraceEngine engine = ENGINE_DEPTH_FIRST;
+    int packetSize = RTRenderOptions().packetSize;
+    bool tileBinning = true;
+    RTMathPrecision mathPrecision = RTRenderOptions().mathPrecision;
+    bool environmentCubemap = false;  // 环境贴图在加载时转换为立方体贴图
+    int maxSpheres = 100000;          // 跳过球体数超过该值的场景
+    std::string filter;               // 只运行名称包含该子串的场景
+    std::string jsonPath = "ray_tracing_bench.json";
+};
+
+// 场景描述：球体数量与材质比例，全部由固定种子生成，保证每次运行完全相同
+struct BenchSceneDesc {
+    const char* name;
+    int sphereCount;
+    float specularRatio;
+    float refractiveRatio;
+    float texturedRatio;   // 漫反射球体中带纹理的比例
+    int lightCount;
+    bool environment;
+};
+
+static const BenchSceneDesc kScenes[] = {
+    // name                spheres  spec   refr   tex    lights env
+    {"solar_3",                 3, 0.00f, 0.00f, 1.00f,  1, false},
+    {"solar_3_env",             3, 0.00f, 0.00f, 1.00f,  1, true},
+    {"mixed_100_env",         100, 0.25f, 0.15f, 0.50f,  2, true},
+    {"mixed_1k",             1000, 0.25f, 0.15f, 0.50f,  4, false},
+    {"diffuse_1k_untextured", 1000, 0.00f, 0.00f, 0.00f,  4, false},
+    {"glass_1k_env",         1000, 0.10f, 0.60f, 0.20f,  4, true},
+    {"mixed_10k_env",       10000, 0.25f, 0.15f, 0.50f,  8, true},
+    {"mixed_100k",         100000, 0.25f, 0.15f, 0.50f, 16, false},
+};
+
+static void PrintUsage() {
+    std::cout <<
+        "ray_tracing_bench [options]\n"
+        "  -w <n> -h <n>        resolution (default 640x360)\n"
+        "  --depth <n>          max trace depth (default 5)\n"
+        "  --frames <n>         measured frames per run (default 10)\n"
+        "  --warmup <n>         unmeasured frames per run (default 2)\n"
+        "  --threads <n>        highest thread count, 0 = all (default 0)\n"
+        "  --no-scaling         only run with the highest thread count\n"
+        "  --wavefront          use the wavefront engine instead of depth-first tracing\n"
+        "  --packet <n>         primary-ray packet size, 0 = per-pixel (default 8)\n"
+        "  --no-binning         find primary hits through the BVH instead of screen tile bins\n"
+        "  --accurate-math      use libm for spherical UVs and specular instead of the fast approximations\n"
+        "  --env-cubemap        convert the environment to a cubemap at load time\n"
+        "  --max-spheres <n>    skip scenes with more spheres (default 100000)\n"
+        "  --scene <substr>     only run scenes whose name contains substr\n"
+        "  --json <path>        JSON report (default ray_tracing_bench.json, '-' for stdout)\n"
+        "  --list               list scenes and exit\n";
+}
+
+static bool ParseArgs(int argc, char** argv, BenchOptions& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto need = [&]() {
+            if (i + 1 >= argc) {
+                std::cerr << "missing value for " << arg << std::endl;
+                return false;
+            }
+            return true;
+        };
+        if (arg == "--help") { PrintUsage(); std::exit(0); }
+        else if (arg == "--list") {
+            for (const BenchSceneDesc& d : kScenes) std::cout << d.name << " (" << d.sphereCount << " spheres)\n";
+            std::exit(0);
+        }
+        else if (arg == "-w" && need()) o.width = std::atoi(argv[++i]);
+        else if (arg == "-h" && need()) o.height = std::atoi(argv[++i]);
+        else if (arg == "--depth" && need()) o.depth = std::atoi(argv[++i]);
+        else if (arg == "--frames" && need()) o.frames = std::atoi(argv[++i]);
+        else if (arg == "--warmup" && need()) o.warmupFrames = std::atoi(argv[++i]);
+        else if (arg == "--threads" && need()) o.maxThreads = std::atoi(argv[++i]);
+        else if (arg == "--no-scaling") o.scaling = false;
+        else if (arg == "--wavefront") o.engine = ENGINE_WAVEFRONT;
+        else if (arg == "--packet" && need()) o.packetSize = std::atoi(argv[++i]);
+        else if (arg == "--no-binning") o.tileBinning = false;
+        else if (arg == "--accurate-math") o.mathPrecision = MATH_PRECISION_ACCURATE;
+        else if (arg == "--env-cubemap") o.environmentCubemap = true;
+        else if (arg == "--max-spheres" && need()) o.maxSpheres = std::atoi(argv[++i]);
+        else if (arg == "--scene" && need()) o.filter = argv[++i];
+        else if (arg == "--json" && need()) o.jsonPath = argv[++i];
+        else {
+            std::cerr << "unknown option " << arg << std::endl;
+            PrintUsage();
+            return false;
+        }
+    }
+    if (o.width <= 0 || o.height <= 0 || o.frames <= 0 || o.warmupFrames < 0) {
+        std::cerr << "invalid resolution or frame count" << std::endl;
+        return false;
+    }
+    if (o.maxThreads <= 0) o.maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    return true;
+}
+
+// 程序化纹理：棋盘格叠加颜色渐变，避免基准依赖 material 目录下的图片
+static RTTexture MakeCheckerTexture(int size, int cells, const glm::vec3& a, const glm::vec3& b) {
+    RTTexture tex{size, size, 3, std::vector<unsigned char>(static_cast<size_t>(size) * size * 3)};
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            bool odd = ((x * cells / size) + (y * cells / size)) & 1;
+            glm::vec3 c = (odd ? a : b) * (0.6f + 0.4f * y / size);
+            unsigned char* p = &tex.data[(static_cast<size_t>(y) * size + x) * 3];
+            for (int k = 0; k < 3; ++k) p[k] = static_cast<unsigned char>(glm::clamp(c[k], 0.0f, 1.0f) * 255.0f);
+        }
+    }
+    return tex;
+}
+
+// 等距柱状投影的天空：天顶到地平线的渐变
+static RTTexture MakeSkyTexture(int width, int height) {
+    RTTexture tex{width, height, 3, std::vector<unsigned char>(static_cast<size_t>(width) * height * 3)};
+    for (int y = 0; y < height; ++y) {
+        float t = static_cast<float>(y) / (height - 1);
+        glm::vec3 c = glm::mix(glm::vec3(0.15f, 0.3f, 0.7f), glm::vec3(0.8f, 0.75f, 0.6f), t);
+        for (int x = 0; x < width; ++x) {
+            unsigned char* p = &tex.data[(static_cast<size_t>(y) * width + x) * 3];
+            for (int k = 0; k < 3; ++k) p[k] = static_cast<unsigned char>(c[k] * 255.0f);
+        }
+    }
+    return tex;
+}
+
+struct BenchScene {
+    std::vector<RTSphereData> spheres;
+    std::vector<RTMaterial> materials;
+    std::vector<RTTextureHandle> materialTextures;
+    glm::vec3 cameraPos;
+    glm::vec3 target;
+};
+
+static RTMaterial MakeMaterial(const glm::vec3& color, int type, const glm::vec3& emission = glm::vec3(0.0f)) {
+    RTMaterial m{};
+    m.color = color;
+    m.emission = emission;
+    m.type = type;
+    m.roughness = 0.0f;
+    m.ior = 1.45f;
+    return m;
+}
+
+static RTSphereData MakeSphere(const glm::vec3& center, float radius, int material) {
+    RTSphereData s{};
+    s.center = center;
+    s.radius = radius;
+    s.materialIndex = material;
+    return s;
+}
+
+static BenchScene BuildScene(const BenchSceneDesc& desc, const std::vector<RTTextureHandle>& textures) {
+    BenchScene scene;
+    // 材质表：一个光源材质，之后每种表面材质各 variants 个
+    RTRandom rng(0x5eedu + desc.sphereCount);
+    auto randomColor = [&]() { return glm::vec3(0.3f) + 0.7f * glm::vec3(rng.NextFloat(), rng.NextFloat(), rng.NextFloat()); };
+
+    int lightMaterial = static_cast<int>(scene.materials.size());
+    scene.materials.push_back(MakeMaterial(glm::vec3(1.0f), DIFFUSE, glm::vec3(1.0f)));
+    scene.materialTextures.push_back(RT_INVALID_TEXTURE);
+
+    const int variants = 4;
+    int diffuseFirst = static_cast<int>(scene.materials.size());
+    for (int i = 0; i < variants; ++i) {
+        scene.materials.push_back(MakeMaterial(randomColor(), DIFFUSE));
+        scene.materialTextures.push_back(RT_INVALID_TEXTURE);
+    }
+    int texturedFirst = static_cast<int>(scene.materials.size());
+    for (int i = 0; i < variants; ++i) {
+        scene.materials.push_back(MakeMaterial(glm::vec3(1.0f), DIFFUSE));
+        scene.materialTextures.push_back(textures[i % textures.size()]);
+    }
+    int specularFirst = static_cast<int>(scene.materials.size());
+    for (int i = 0; i < variants; ++i) {
+        scene.materials.push_back(MakeMaterial(randomColor(), SPECULAR));
+        scene.materialTextures.push_back(RT_INVALID_TEXTURE);
+    }
+    int refractiveFirst = static_cast<int>(scene.materials.size());
+    for (int i = 0; i < variants; ++i) {
+        scene.materials.push_back(MakeMaterial(glm::vec3(0.9f) + 0.1f * randomColor(), REFRACTIVE));
+        scene.materialTextures.push_back(RT_INVALID_TEXTURE);
+    }
+
+    if (desc.sphereCount <= 3) {
+        // 与演示程序相同的太阳、地球、月球
+        glm::vec3 earth(8.0f * std::cos(0.3f), 8.0f * std::sin(0.3f), 0.0f);
+        scene.spheres.push_back(MakeSphere(glm::vec3(0.0f), 2.0f, lightMaterial));
+        scene.spheres.push_back(MakeSphere(earth, 0.6f, texturedFirst));
+        scene.spheres.push_back(MakeSphere(earth + glm::vec3(1.0f, 0.0f, 0.0f), 0.2f, texturedFirst + 1));
+        scene.cameraPos = glm::vec3(0.0f, 18.0f, 6.0f);
+        scene.target = glm::vec3(0.0f);
+        return scene;
+    }
+
+    // 球体均匀分布在边长随数量增长的立方体内，密度保持不变
+    float extent = 2.0f * std::cbrt(static_cast<float>(desc.sphereCount));
+    int lights = std::min(desc.lightCount, desc.sphereCount);
+    for (int i = 0; i < desc.sphereCount; ++i) {
+        glm::vec3 center = (glm::vec3(rng.NextFloat(), rng.NextFloat(), rng.NextFloat()) * 2.0f - 1.0f) * extent;
+        if (i < lights) {
+            center.z = extent * 1.5f; // 光源悬在上方
+            scene.spheres.push_back(MakeSphere(center, 0.1f * extent + 0.5f, lightMaterial));
+            continue;
+        }
+        float radius = 0.2f + 0.4f * rng.NextFloat();
+        float pick = rng.NextFloat();
+        int variant = static_cast<int>(rng.NextFloat() * variants) % variants;
+        int material;
+        if (pick < desc.specularRatio) material = specularFirst + variant;
+        else if (pick < desc.specularRatio + desc.refractiveRatio) material = refractiveFirst + variant;
+        else if (rng.NextFloat() < desc.texturedRatio) material = texturedFirst + variant;
+        else material = diffuseFirst + variant;
+        scene.spheres.push_back(MakeSphere(center, radius, material));
+    }
+    scene.cameraPos = glm::vec3(0.0f, -2.2f * extent, 0.8f * extent);
+    scene.target = glm::vec3(0.0f);
+    return scene;
+}
+
+struct BenchRun {
+    int threads = 0;
+    std::vector<double> frameMs;
+    double meanMs = 0.0, minMs = 0.0, maxMs = 0.0, p50 = 0.0, p90 = 0.0, p99 = 0.0;
+    double raysPerFrame = 0.0;
+    double primaryRaysPerSec = 0.0;
+    double totalRaysPerSec = 0.0;
+    double speedup = 1.0;      // 相对单线程（没有单线程结果时为 1）
+};
+
+static double Percentile(const std::vector<double>& sorted, double p) {
+    // 线性插值的分位数；sorted 已排序
+    if (sorted.empty()) return 0.0;
+    double pos = p * (sorted.size() - 1);
+    size_t lo = static_cast<size_t>(pos);
+    size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - lo);
+}
+
+static BenchRun RunScene(RayTracer& tracer, RTScene& scene, const BenchScene& desc,
+                         const BenchOptions& o, int threads) {
+    RTRenderOptions rtOptions;
+    rtOptions.threadCount = threads;
+    rtOptions.engine = o.engine;
+    rtOptions.packetSize = o.packetSize;
+    rtOptions.tileBinning = o.tileBinning;
+    rtOptions.mathPrecision = o.mathPrecision;
+    tracer.SetOptions(rtOptions);
+
+    glm::mat4 view = glm::lookAt(desc.cameraPos, desc.target, glm::vec3(0.0f, 0.0f, 1.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), static_cast<float>(o.width) / o.height, 0.1f, 1000.0f);
+
+    // 预热：建立 BVH、唤醒线程池、预热缓存
+    for (int i = 0; i < o.warmupFrames; ++i) {
+        tracer.Render(scene, desc.cameraPos, view, projection, static_cast<float>(o.depth));
+    }
+
+    BenchRun run;
+    run.threads = tracer.GetFrameTiming().threads;
+    double totalMs = 0.0, totalRays = 0.0;
+    for (int i = 0; i < o.frames; ++i) {
+        tracer.Render(scene, desc.cameraPos, view, projection, static_cast<float>(o.depth));
+        const RTFrameTiming& timing = tracer.GetFrameTiming();
+        run.frameMs.push_back(timing.frameMs);
+        totalMs += timing.frameMs;
+        totalRays += static_cast<double>(timing.rays);
+        run.threads = timing.threads;
+    }
+
+    std::vector<double> sorted = run.frameMs;
+    std::sort(sorted.begin(), sorted.end());
+    run.meanMs = totalMs / o.frames;
+    run.minMs = sorted.front();
+    run.maxMs = sorted.back();
+    run.p50 = Percentile(sorted, 0.50);
+    run.p90 = Percentile(sorted, 0.90);
+    run.p99 = Percentile(sorted, 0.99);
+    run.raysPerFrame = totalRays / o.frames;
+    double seconds = totalMs / 1000.0;
+    if (seconds > 0.0) {
+        run.primaryRaysPerSec = static_cast<double>(o.width) * o.height * o.frames / seconds;
+        run.totalRaysPerSec = totalRays / seconds;
+    }
+    return run;
+}
+
+static std::vector<int> ThreadCounts(const BenchOptions& o) {
+    std::vector<int> counts;
+    if (o.scaling) {
+        for (int t = 1; t < o.maxThreads; t *= 2) counts.push_back(t);
+    }
+    counts.push_back(o.maxThreads);
+    return counts;
+}
+
+struct SceneResult {
+    const BenchSceneDesc* desc;
+    double setupMs;            // 首帧（含 BVH 构建）耗时
+    std::vector<BenchRun> runs;
+};
+
+static std::string JsonNumber(double v) {
+    std::ostringstream s;
+    s.precision(6);
+    s << (std::isfinite(v) ? v : 0.0);
+    return s.str();
+}
+
+static void WriteJson(std::ostream& out, const BenchOptions& o, const std::vector<SceneResult>& results) {
+    out << "{\n";
+    out << "  \"benchmark\": \"ray_tracing_bench\",\n";
+    out << "  \"width\": " << o.width << ", \"height\": " << o.height << ", \"depth\": " << o.depth << ",\n";
+    out << "  \"frames\": " << o.frames << ", \"warmupFrames\": " << o.warmupFrames << ",\n";
+    out << "  \"hardwareThreads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "  \"simd\": \"" << RTSimdLevelName(RTDetectSimdLevel()) << "\",\n";
+    out << "  \"engine\": \"" << (o.engine == ENGINE_WAVEFRONT ? "wavefront" : "depth_first") << "\","
+        << " \"packetSize\": " << o.packetSize << ", \"tileBinning\": " << (o.tileBinning ? "true" : "false")
+        << ", \"mathPrecision\": \"" << (o.mathPrecision == MATH_PRECISION_FAST ? "fast" : "accurate") << "\","
+        << " \"environmentCubemap\": " << (o.environmentCubemap ? "true" : "false") << ",\n";
+    out << "  \"scenes\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const SceneResult& r = results[i];
+        out << "    {\"name\": \"" << r.desc->name << "\", \"spheres\": " << r.desc->sphereCount
+            << ", \"environment\": " << (r.desc->environment ? "true" : "false")
+            << ", \"setupMs\": " << JsonNumber(r.setupMs) << ", \"runs\": [\n";
+        for (size_t j = 0; j < r.runs.size(); ++j) {
+            const BenchRun& run = r.runs[j];
+            out << "      {\"threads\": " << run.threads
+                << ", \"meanMs\": " << JsonNumber(run.meanMs)
+                << ", \"minMs\": " << JsonNumber(run.minMs)
+                << ", \"p50Ms\": " << JsonNumber(run.p50)
+                << ", \"p90Ms\": " << JsonNumber(run.p90)
+                << ", \"p99Ms\": " << JsonNumber(run.p99)
+                << ", \"maxMs\": " << JsonNumber(run.maxMs)
+                << ", \"raysPerFrame\": " << JsonNumber(run.raysPerFrame)
+                << ", \"primaryRaysPerSec\": " << JsonNumber(run.primaryRaysPerSec)
+                << ", \"totalRaysPerSec\": " << JsonNumber(run.totalRaysPerSec)
+                << ", \"speedup\": " << JsonNumber(run.speedup) << "}"
+                << (j + 1 < r.runs.size() ? "," : "") << "\n";
+        }
+        out << "    ]}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+int main(int argc, char** argv) {
+    BenchOptions o;
+    if (!ParseArgs(argc, argv, o)) return 1;
+
+    std::vector<SceneResult> results;
+    std::printf("%-24s %8s %7s %9s %9s %9s %9s %10s %10s %8s\n", "scene", "spheres", "threads",
+                "mean ms", "p50 ms", "p90 ms", "p99 ms", "Mprim/s", "Mrays/s", "speedup");
+
+    for (const BenchSceneDesc& desc : kScenes) {
+        if (desc.sphereCount > o.maxSpheres) continue;
+        if (!o.filter.empty() && std::string(desc.name).find(o.filter) == std::string::npos) continue;
+
+        // 每个场景一个新的 RayTracer，互不影响（纹理、BVH、缓存）
+        RayTracer tracer(o.width, o.height);
+        std::vector<RTTextureHandle> textures;
+        textures.push_back(tracer.RegisterTexture(MakeCheckerTexture(256, 8, glm::vec3(0.9f, 0.5f, 0.2f), glm::vec3(0.2f, 0.4f, 0.9f))));
+        textures.push_back(tracer.RegisterTexture(MakeCheckerTexture(512, 16, glm::vec3(0.8f), glm::vec3(0.3f))));
+        textures.push_back(tracer.RegisterTexture(MakeCheckerTexture(1024, 32, glm::vec3(0.3f, 0.8f, 0.3f), glm::vec3(0.9f, 0.9f, 0.2f))));
+        if (desc.environment) tracer.SetEnvironmentTexture(MakeSkyTexture(1024, 512), o.environmentCubemap);
+
+        BenchScene benchScene = BuildScene(desc, textures);
+        RTScene scene;
+        scene.Assign(benchScene.spheres, benchScene.materials, benchScene.materialTextures);
+
+        SceneResult result;
+        result.desc = &desc;
+        {
+            // 首帧单独计时：包含 BVH、SoA 与光源列表的构建
+            glm::mat4 view = glm::lookAt(benchScene.cameraPos, benchScene.target, glm::vec3(0.0f, 0.0f, 1.0f));
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), static_cast<float>(o.width) / o.height, 0.1f, 1000.0f);
+            tracer.Render(scene, benchScene.cameraPos, view, projection, static_cast<float>(o.depth));
+            result.setupMs = tracer.GetFrameTiming().frameMs;
+        }
+
+        double singleThreadMs = 0.0;
+        for (int threads : ThreadCounts(o)) {
+            BenchRun run = RunScene(tracer, scene, benchScene, o, threads);
+            if (run.threads == 1) singleThreadMs = run.meanMs;
+            run.speedup = (singleThreadMs > 0.0 && run.meanMs > 0.0) ? singleThreadMs / run.meanMs : 1.0;
+            std::printf("%-24s %8d %7d %9.2f %9.2f %9.2f %9.2f %10.2f %10.2f %7.2fx\n", desc.name, desc.sphereCount,
+                        run.threads, run.meanMs, run.p50, run.p90, run.p99,
+                        run.primaryRaysPerSec / 1e6, run.totalRaysPerSec / 1e6, run.speedup);
+            std::fflush(stdout);
+            result.runs.push_back(run);
+        }
+        results.push_back(result);
+    }
+
+    if (o.jsonPath == "-") {
+        WriteJson(std::cout, o, results);
+    } else {
+        std::ofstream file(o.jsonPath);
+        if (!file) {
+            std::cerr << "Failed to write " << o.jsonPath << std::endl;
+            return 1;
+        }
+        WriteJson(file, o, results);
+        std::cout << "wrote " << o.jsonPath << std::endl;
+    }
+    return 0;
+}
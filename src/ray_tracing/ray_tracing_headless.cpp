@@ -0,0 +1,259 @@
+// 无窗口的离线渲染：不创建 OpenGL 上下文，把 CPU 光线追踪结果写入 PPM / PNG / PFM
+// 用法见 PrintUsage；场景与 ray_tracing 演示程序相同（太阳、地球、月球）
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <glm.hpp>
+#include <gtc/matrix_transform.hpp>
+#include <stb_image.h>
+#include "RayTracer.h"
+#include "RTImageIO.h"
+
+struct HeadlessOptions {
+    std::string output = "frame.png";
+    std::string materialDir = "material";
+    std::string environment;             // 环境贴图，空表示不使用
+    std::vector<std::string> environmentFaces; // 立方体贴图的六个面（+X -X +Y -Y +Z -Z），优先于 environment
+    int cubemapSize = -1;                // >= 0 时把 environment 转换为立方体贴图（0 为自动选择面的边长）
+    int width = 1280;
+    int height = 720;
+    int samples = 1;                     // 每像素采样数（渐进累加）
+    int depth = 5;
+    int threads = 0;
+    float timeBegin = 0.0f;
+    float timeEnd = 0.0f;                // > timeBegin 时输出序列
+    float fps = 30.0f;
+    glm::vec3 cameraPos = glm::vec3(0.0f, 18.0f, 6.0f);
+    glm::vec3 cameraTarget = glm::vec3(0.0f);
+    float fov = 45.0f;
+    bool accurateMath = false;           // 参考渲染：UV 与高光使用 libm 而非多项式近似
+};
+
+// 输出路径中的帧号占位符：第一个 %d 或 %0Nd 的位置、长度与补零宽度（pos 为 npos 表示没有占位符）
+struct FramePattern {
+    size_t pos = std::string::npos;
+    size_t length = 0;
+    int width = 0;
+};
+
+// 路径不作为 printf 格式串使用：只接受一个 %d / %0Nd（N 为 1 ~ 2 位数字），其余的 % 一律视为错误
+static bool ParseFramePattern(const std::string& pattern, FramePattern& out) {
+    out = FramePattern();
+    for (size_t i = pattern.find('%'); i != std::string::npos; i = pattern.find('%', i + 1)) {
+        size_t j = i + 1;
+        int width = 0;
+        if (j < pattern.size() && pattern[j] == '0') {
+            size_t digits = ++j;
+            while (j < pattern.size() && j - digits < 2 && pattern[j] >= '0' && pattern[j] <= '9') {
+                width = width * 10 + (pattern[j++] - '0');
+            }
+            if (j == digits) return false; // 只有 %0
+        }
+        if (j >= pattern.size() || pattern[j] != 'd' || out.pos != std::string::npos) return false;
+        out.pos = i;
+        out.length = j + 1 - i;
+        out.width = width;
+        i = j;
+    }
+    return true;
+}
+
+static void PrintUsage() {
+    std::cout <<
+        "ray_tracing_headless [options]\n"
+        "  -o <path>            output image, .ppm/.png/.pfm (default frame.png)\n"
+        "                       for sequences the first %d or %0Nd (N < 100) is replaced by the frame number,\n"
+        "                       other % sequences are rejected;\n"
+        "                       otherwise _0000 is inserted before the extension\n"
+        "  -w <n> -h <n>        resolution (default 1280x720)\n"
+        "  --spp <n>            samples per pixel (default 1)\n"
+        "  --depth <n>          max trace depth (default 5)\n"
+        "  --threads <n>        worker threads, 0 = all (default 0)\n"
+        "  --time <t>           scene time in seconds (default 0)\n"
+        "  --end <t>            render a sequence from --time to --end\n"
+        "  --fps <f>            sequence frame rate (default 30)\n"
+        "  --camera <x y z>     camera position (default 0 18 6)\n"
+        "  --target <x y z>     look-at point (default 0 0 0)\n"
+        "  --fov <deg>          vertical field of view (default 45)\n"
+        "  --materials <dir>    texture directory (default material)\n"
+        "  --env <path>         environment (equirectangular) texture\n"
+        "  --env-cubemap <n>    convert --env to a cubemap with n x n faces at load time, 0 = width / 4\n"
+        "  --env-faces <+x -x +y -y +z -z>\n"
+        "                       environment cubemap from six square face images\n"
+        "  --accurate-math      use libm instead of the fast approximations (reference renders)\n";
+}
+
+static bool ParseArgs(int argc, char** argv, HeadlessOptions& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto need = [&](int n) {
+            if (i + n >= argc) {
+                std::cerr << "missing value for " << arg << std::endl;
+                return false;
+            }
+            return true;
+        };
+        if (arg == "--help") { PrintUsage(); std::exit(0); }
+        else if (arg == "-o" && need(1)) o.output = argv[++i];
+        else if (arg == "-w" && need(1)) o.width = std::atoi(argv[++i]);
+        else if (arg == "-h" && need(1)) o.height = std::atoi(argv[++i]);
+        else if (arg == "--spp" && need(1)) o.samples = std::atoi(argv[++i]);
+        else if (arg == "--depth" && need(1)) o.depth = std::atoi(argv[++i]);
+        else if (arg == "--threads" && need(1)) o.threads = std::atoi(argv[++i]);
+        else if (arg == "--time" && need(1)) o.timeBegin = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--end" && need(1)) o.timeEnd = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--fps" && need(1)) o.fps = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--fov" && need(1)) o.fov = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--materials" && need(1)) o.materialDir = argv[++i];
+        else if (arg == "--env" && need(1)) o.environment = argv[++i];
+        else if (arg == "--env-cubemap" && need(1)) o.cubemapSize = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--env-faces" && need(6)) {
+            o.environmentFaces.assign(argv + i + 1, argv + i + 7);
+            i += 6;
+        }
+        else if (arg == "--accurate-math") o.accurateMath = true;
+        else if ((arg == "--camera" || arg == "--target") && need(3)) {
+            glm::vec3 v(std::atof(argv[i + 1]), std::atof(argv[i + 2]), std::atof(argv[i + 3]));
+            (arg == "--camera" ? o.cameraPos : o.cameraTarget) = v;
+            i += 3;
+        } else {
+            std::cerr << "unknown option " << arg << std::endl;
+            PrintUsage();
+            return false;
+        }
+    }
+    if (o.width <= 0 || o.height <= 0 || o.samples <= 0 || o.fps <= 0.0f) {
+        std::cerr << "invalid resolution, sample count or frame rate" << std::endl;
+        return false;
+    }
+    FramePattern placeholder;
+    if (o.timeEnd > o.timeBegin && !ParseFramePattern(o.output, placeholder)) {
+        std::cerr << "invalid frame pattern in " << o.output << ": the only % sequence allowed is a single %d or %0Nd" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static RTTexture LoadTexture(const std::string& path) {
+    RTTexture tex{0, 0, 0, {}};
+    unsigned char* data = stbi_load(path.c_str(), &tex.width, &tex.height, &tex.channels, 0);
+    if (data) {
+        tex.data.assign(data, data + tex.width * tex.height * tex.channels);
+        stbi_image_free(data);
+    } else {
+        std::cerr << "Failed to load texture " << path << std::endl;
+        tex.width = tex.height = tex.channels = 0;
+    }
+    return tex;
+}
+
+// 与演示程序相同的公转关系：地球绕太阳（半径 8），月球绕地球（半径 1）
+struct SolarSystem {
+    RTSphereHandle sun, earth, moon;
+
+    void Update(RTScene& scene, float t) const {
+        glm::vec3 earthPos(8.0f * std::cos(t / 20), 8.0f * std::sin(t / 20), 0.0f);
+        glm::vec3 moonPos = earthPos + glm::vec3(std::cos(t), std::sin(t), 0.0f);
+        scene.UpdateSphere(sun, glm::vec3(0.0f), 2.0f);
+        scene.UpdateSphere(earth, earthPos, 0.6f);
+        scene.UpdateSphere(moon, moonPos, 0.2f);
+    }
+};
+
+static SolarSystem BuildScene(RayTracer& tracer, RTScene& scene, const std::string& dir) {
+    auto AddObject = [&](const char* texture, const glm::vec3& color, const glm::vec3& emission, int type, float radius) {
+        RTMaterial material{};
+        material.color = color;
+        material.emission = emission;
+        material.type = type;
+        material.roughness = 0.0f;
+        material.ior = 1.45f;
+        RTTexture tex = LoadTexture(dir + "/" + texture);
+        RTTextureHandle handle = tex.data.empty() ? RT_INVALID_TEXTURE : tracer.RegisterTexture(std::move(tex));
+        return scene.AddSphere(glm::vec3(0.0f), radius, scene.AddMaterial(material, handle));
+    };
+    SolarSystem system;
+    system.sun = AddObject("sun.jpg", glm::vec3(0.9f, 0.9f, 0.8f), glm::vec3(1.0f), DIFFUSE, 2.0f);
+    system.earth = AddObject("earth.png", glm::vec3(0.0f), glm::vec3(0.0f), SPECULAR, 0.6f);
+    system.moon = AddObject("moon.jpg", glm::vec3(0.7f), glm::vec3(0.0f), DIFFUSE, 0.2f);
+    return system;
+}
+
+// 序列的第 frame 帧的输出路径；pattern 已经过 ParseFramePattern 检查
+static std::string FramePath(const std::string& pattern, int frame, bool sequence) {
+    if (!sequence) return pattern;
+    FramePattern placeholder;
+    ParseFramePattern(pattern, placeholder);
+    char buffer[128];
+    if (placeholder.pos != std::string::npos) {
+        std::snprintf(buffer, sizeof(buffer), "%0*d", placeholder.width, frame);
+        return pattern.substr(0, placeholder.pos) + buffer + pattern.substr(placeholder.pos + placeholder.length);
+    }
+    size_t dot = pattern.find_last_of('.');
+    std::snprintf(buffer, sizeof(buffer), "_%04d", frame);
+    if (dot == std::string::npos) return pattern + buffer;
+    return pattern.substr(0, dot) + buffer + pattern.substr(dot);
+}
+
+int main(int argc, char** argv) {
+    HeadlessOptions o;
+    if (!ParseArgs(argc, argv, o)) return 1;
+
+    RayTracer tracer(o.width, o.height);
+    RTRenderOptions rtOptions;
+    rtOptions.threadCount = o.threads;
+    rtOptions.progressive = true;   // 多次 Render 累加到 spp 个采样
+    rtOptions.progressiveMaxSamples = o.samples;
+    if (o.accurateMath) rtOptions.mathPrecision = MATH_PRECISION_ACCURATE;
+    tracer.SetOptions(rtOptions);
+
+    if (!o.environmentFaces.empty()) {
+        std::vector<RTTexture> faces;
+        for (const std::string& path : o.environmentFaces) faces.push_back(LoadTexture(path));
+        if (!tracer.SetEnvironmentCubemap(faces)) {
+            std::cerr << "cubemap faces must be square images of the same size" << std::endl;
+            return 1;
+        }
+    } else if (!o.environment.empty()) {
+        RTTexture env = LoadTexture(o.environment);
+        if (!env.data.empty()) tracer.SetEnvironmentTexture(env, o.cubemapSize >= 0, o.cubemapSize);
+    }
+
+    RTScene scene;
+    SolarSystem system = BuildScene(tracer, scene, o.materialDir);
+
+    glm::mat4 view = glm::lookAt(o.cameraPos, o.cameraTarget, glm::vec3(0.0f, 0.0f, 1.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(o.fov), static_cast<float>(o.width) / o.height, 0.1f, 100.0f);
+
+    bool sequence = o.timeEnd > o.timeBegin;
+    int frameCount = sequence ? static_cast<int>((o.timeEnd - o.timeBegin) * o.fps) + 1 : 1;
+    std::vector<glm::vec3> hdr;
+
+    for (int frame = 0; frame < frameCount; ++frame) {
+        float t = o.timeBegin + frame / o.fps;
+        system.Update(scene, t);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int s = 0; s < o.samples; ++s) {
+            tracer.Render(scene, o.cameraPos, view, projection, static_cast<float>(o.depth));
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+        std::string path = FramePath(o.output, frame, sequence);
+        tracer.GetAccumulatedImage(hdr);
+        if (!RTWriteImage(path, tracer.GetRenderWidth(), tracer.GetRenderHeight(), tracer.GetPixels(), &hdr)) {
+            std::cerr << "Failed to write " << path << std::endl;
+            return 1;
+        }
+        double primaryRays = static_cast<double>(o.width) * o.height * o.samples;
+        std::cout << path << ": t=" << t << "s, " << elapsed.count() << " ms, "
+                  << primaryRays / (elapsed.count() * 1000.0) << " M primary rays/s" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,560 @@
+// 内核微基准：在大批量随机输入上单独测量 RTKernels.h 中的热点函数与 RTSimd 求交内核，
+// 以每次调用的纳秒数比较不同实现（SIMD、快速数学函数、纹理布局等）
+// 用法见 PrintUsage
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <glm.hpp>
+#include <stb_image.h>
+#include "RTKernels.h"
+#include "RTSimd.h"
+#include "RTRandom.h"
+
+struct KernelBenchOptions {
+    int count = 1 << 20;   // 每批输入数量
+    int repeats = 7;       // 每个内核重复整批的次数，报告最小值与中位数
+    std::string filter;    // 只运行名称包含该子串的内核
+    std::string materialDir = "material"; // 纹理布局对比使用的地球与银河纹理所在目录
+    std::string jsonPath = "ray_tracing_kernel_bench.json";
+};
+
+struct KernelResult {
+    std::string name;
+    double callsPerBatch = 0.0;
+    double minNs = 0.0;    // 每次调用
+    double medianNs = 0.0;
+};
+
+static void PrintUsage() {
+    std::cout <<
+        "ray_tracing_kernel_bench [options]\n"
+        "  --count <n>          inputs per batch (default 1048576)\n"
+        "  --repeats <n>        timed batches per kernel (default 7)\n"
+        "  --kernel <substr>    only run kernels whose name contains substr\n"
+        "  --materials <dir>    earth.png / milky_way.png for the texture layout cases (default material)\n"
+        "  --json <path>        JSON report (default ray_tracing_kernel_bench.json, '-' for stdout)\n";
+}
+
+static bool ParseArgs(int argc, char** argv, KernelBenchOptions& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto need = [&]() {
+            if (i + 1 >= argc) {
+                std::cerr << "missing value for " << arg << std::endl;
+                return false;
+            }
+            return true;
+        };
+        if (arg == "--help") { PrintUsage(); std::exit(0); }
+        else if (arg == "--count" && need()) o.count = std::atoi(argv[++i]);
+        else if (arg == "--repeats" && need()) o.repeats = std::atoi(argv[++i]);
+        else if (arg == "--kernel" && need()) o.filter = argv[++i];
+        else if (arg == "--materials" && need()) o.materialDir = argv[++i];
+        else if (arg == "--json" && need()) o.jsonPath = argv[++i];
+        else {
+            std::cerr << "unknown option " << arg << std::endl;
+            PrintUsage();
+            return false;
+        }
+    }
+    if (o.count <= 0 || o.repeats <= 0) {
+        std::cerr << "invalid count or repeat count" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 防止编译器把结果未被使用的调用整体删除
+static volatile float gSink = 0.0f;
+
+static glm::vec3 RandomUnitVector(RTRandom& rng) {
+    float z = rng.NextFloat() * 2.0f - 1.0f;
+    float phi = rng.NextFloat() * 6.2831853f;
+    float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+    return glm::vec3(r * std::cos(phi), r * std::sin(phi), z);
+}
+
+// 程序化 RGB 纹理：值噪声风格的随机块，使相邻纹素不完全相同
+static RTTexture MakeNoiseTexture(int width, int height, uint32_t seed) {
+    RTTexture tex{width, height, 3, std::vector<unsigned char>(static_cast<size_t>(width) * height * 3)};
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            uint32_t h = RTRandom::Hash(seed ^ RTRandom::Hash((y / 4) * 4099u + (x / 4)));
+            unsigned char* p = &tex.data[(static_cast<size_t>(y) * width + x) * 3];
+            p[0] = static_cast<unsigned char>(h);
+            p[1] = static_cast<unsigned char>(h >> 8);
+            p[2] = static_cast<unsigned char>(h >> 16);
+        }
+    }
+    return tex;
+}
+
+// 读取失败时返回空纹理
+static RTTexture LoadTexture(const std::string& path) {
+    RTTexture tex{0, 0, 0, {}};
+    unsigned char* data = stbi_load(path.c_str(), &tex.width, &tex.height, &tex.channels, 0);
+    if (data) {
+        tex.data.assign(data, data + tex.width * tex.height * tex.channels);
+        stbi_image_free(data);
+    } else {
+        tex.width = tex.height = tex.channels = 0;
+    }
+    return tex;
+}
+
+// 渲染器的访问顺序：side x side 像素的画面上一个铺满画面的旋转球体，按 8x8 像素块逐块、
+// 块内逐行求球面 UV（与主光线包的顺序相同），只保留命中球体的像素
+static void SphereScanUV(int side, std::vector<float>& us, std::vector<float>& vs) {
+    us.clear();
+    vs.clear();
+    const float tilt = 0.4f, spin = 1.3f;
+    for (int by = 0; by < side; by += 8) {
+        for (int bx = 0; bx < side; bx += 8) {
+            for (int y = by; y < std::min(by + 8, side); ++y) {
+                for (int x = bx; x < std::min(bx + 8, side); ++x) {
+                    float sx = (x + 0.5f) / side * 2.0f - 1.0f;
+                    float sy = 1.0f - (y + 0.5f) / side * 2.0f;
+                    float r2 = sx * sx + sy * sy;
+                    if (r2 >= 1.0f) continue;
+                    glm::vec3 n(sx, sy, std::sqrt(1.0f - r2));
+                    n = glm::vec3(n.x, n.y * std::cos(tilt) - n.z * std::sin(tilt), n.y * std::sin(tilt) + n.z * std::cos(tilt));
+                    n = glm::vec3(n.x * std::cos(spin) + n.z * std::sin(spin), n.y, -n.x * std::sin(spin) + n.z * std::cos(spin));
+                    float u, v;
+                    RTDirectionToUV(n, u, v);
+                    us.push_back(u);
+                    vs.push_back(v);
+                }
+            }
+        }
+    }
+}
+
+// 运行 repeats 批（另加一批预热），batch() 返回本批的调用次数
+static KernelResult Measure(const std::string& name, const KernelBenchOptions& o, const std::function<double()>& batch) {
+    KernelResult result;
+    result.name = name;
+    result.callsPerBatch = batch();
+    std::vector<double> ns;
+    for (int r = 0; r < o.repeats; ++r) {
+        auto start = std::chrono::high_resolution_clock::now();
+        double calls = batch();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::high_resolution_clock::now() - start;
+        ns.push_back(elapsed.count() / std::max(1.0, calls));
+    }
+    std::sort(ns.begin(), ns.end());
+    result.minNs = ns.front();
+    result.medianNs = ns[ns.size() / 2];
+    return result;
+}
+
+static std::string JsonNumber(double v) {
+    std::ostringstream s;
+    s.precision(6);
+    s << (std::isfinite(v) ? v : 0.0);
+    return s.str();
+}
+
+static void WriteJson(std::ostream& out, const KernelBenchOptions& o, const std::vector<KernelResult>& results) {
+    out << "{\n";
+    out << "  \"benchmark\": \"ray_tracing_kernel_bench\",\n";
+    out << "  \"count\": " << o.count << ", \"repeats\": " << o.repeats << ",\n";
+    out << "  \"simd\": \"" << RTSimdLevelName(RTDetectSimdLevel()) << "\",\n";
+    out << "  \"kernels\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const KernelResult& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"callsPerBatch\": " << JsonNumber(r.callsPerBatch)
+            << ", \"minNs\": " << JsonNumber(r.minNs) << ", \"medianNs\": " << JsonNumber(r.medianNs) << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+int main(int argc, char** argv) {
+    KernelBenchOptions o;
+    if (!ParseArgs(argc, argv, o)) return 1;
+
+    const size_t n = static_cast<size_t>(o.count);
+    RTRandom rng(12345u);
+
+    // 射线与球体：起点在单位立方体内随机，方向指向球体附近，约一半命中
+    std::vector<glm::vec3> origins(n), dirs(n);
+    std::vector<RTSphereData> spheres(n);
+    for (size_t i = 0; i < n; ++i) {
+        RTSphereData s{};
+        s.center = glm::vec3(rng.NextFloat(), rng.NextFloat(), rng.NextFloat()) * 20.0f - 10.0f;
+        s.radius = 0.2f + rng.NextFloat();
+        spheres[i] = s;
+        origins[i] = glm::vec3(rng.NextFloat(), rng.NextFloat(), rng.NextFloat()) * 2.0f - 1.0f;
+        glm::vec3 aim = s.center + RandomUnitVector(rng) * (2.0f * s.radius * rng.NextFloat());
+        dirs[i] = glm::normalize(aim - origins[i]);
+    }
+
+    // 纹理坐标：完全随机（缓存不友好）与沿扫描线小步前进（相邻像素的访问模式）
+    std::vector<float> randomU(n), randomV(n), coherentU(n), coherentV(n);
+    for (size_t i = 0; i < n; ++i) {
+        randomU[i] = rng.NextFloat() * 3.0f - 1.0f;
+        randomV[i] = rng.NextFloat() * 3.0f - 1.0f;
+        coherentU[i] = (i % 1024) / 1024.0f * 0.25f;
+        coherentV[i] = (i / 1024 % 1024) / 1024.0f * 0.25f;
+    }
+    RTTexture texture = MakeNoiseTexture(1024, 1024, 7u);
+    RTTexture environment = MakeNoiseTexture(2048, 1024, 11u);
+    RTMipTexture textureMip;
+    textureMip.Build(texture);
+    std::vector<float> lods(n);
+    for (size_t i = 0; i < n; ++i) lods[i] = rng.NextFloat() * 4.0f;
+
+    // 着色输入：单位法线、视线与光线方向
+    std::vector<glm::vec3> normals(n), views(n), lightDirs(n), albedos(n);
+    for (size_t i = 0; i < n; ++i) {
+        normals[i] = RandomUnitVector(rng);
+        views[i] = RandomUnitVector(rng);
+        lightDirs[i] = RandomUnitVector(rng);
+        albedos[i] = glm::vec3(rng.NextFloat(), rng.NextFloat(), rng.NextFloat());
+    }
+
+    std::vector<KernelResult> results;
+    auto run = [&](const std::string& name, const std::function<double()>& batch) {
+        if (!o.filter.empty() && name.find(o.filter) == std::string::npos) return;
+        KernelResult r = Measure(name, o, batch);
+        std::printf("%-40s %10.3f ns/call (median %.3f)\n", r.name.c_str(), r.minNs, r.medianNs);
+        std::fflush(stdout);
+        results.push_back(r);
+    };
+
+    run("intersect_sphere", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            float t;
+            if (RTIntersectSphere(origins[i], dirs[i], spheres[i], t)) sum += t;
+        }
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    // RTSimd 的最近交点内核：每条射线测试一个 8 球体的叶子，按单次射线-球体测试计时
+    const int leafSize = 8;
+    std::vector<int> order(n);
+    for (size_t i = 0; i < n; ++i) order[i] = static_cast<int>(i);
+    RTSphereSoA soa;
+    soa.Build(spheres, order);
+    const RTSimdLevel levels[] = {SIMD_SCALAR, SIMD_SSE, SIMD_AVX2};
+    for (RTSimdLevel level : levels) {
+        RTSimdKernels kernels = RTGetSimdKernels(level);
+        if (kernels.level != level) continue; // CPU 或编译不支持
+        run(std::string("closest_hit_") + RTSimdLevelName(level), [&, kernels]() {
+            float sum = 0.0f;
+            size_t leaves = n / leafSize;
+            for (size_t leaf = 0; leaf < leaves; ++leaf) {
+                size_t ray = leaf * leafSize;
+                float tMax = 1e30f;
+                int hit = -1;
+                kernels.closestHit(soa, static_cast<int>(ray), leafSize, origins[ray], dirs[ray], tMax, hit);
+                sum += hit >= 0 ? tMax : 0.0f;
+            }
+            gSink = sum;
+            return static_cast<double>(leaves * leafSize);
+        });
+    }
+
+    run("direction_to_uv", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            float u, v;
+            RTDirectionToUV(normals[i], u, v);
+            sum += u + v;
+        }
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    // 快速数学函数：先在全部输入上统计与 libm 的最大误差，再分别计时
+    std::vector<float> powBase(n), dirX(n), dirY(n), dirZ(n), batchU(n), batchV(n);
+    for (size_t i = 0; i < n; ++i) {
+        powBase[i] = rng.NextFloat();
+        dirX[i] = normals[i].x;
+        dirY[i] = normals[i].y;
+        dirZ[i] = normals[i].z;
+    }
+    {
+        double atanErr = 0.0, asinErr = 0.0, powErr = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            atanErr = std::max(atanErr, std::fabs(static_cast<double>(RTFastAtan2(normals[i].z, normals[i].x)) -
+                                                  std::atan2(static_cast<double>(normals[i].z), normals[i].x)));
+            asinErr = std::max(asinErr, std::fabs(static_cast<double>(RTFastAsin(normals[i].y)) -
+                                                  std::asin(static_cast<double>(normals[i].y))));
+            double exact = std::pow(static_cast<double>(powBase[i]), 32.0);
+            if (exact > 1e-30) powErr = std::max(powErr, std::fabs(RTFastPow(powBase[i], 32.0f) / exact - 1.0));
+        }
+        std::printf("fast math max error: atan2 %.3g rad, asin %.3g rad, pow(x, 32) %.3g relative\n",
+                    atanErr, asinErr, powErr);
+    }
+
+    run("atan2_std", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += std::atan2(dirZ[i], dirX[i]);
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    run("atan2_fast", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += RTFastAtan2(dirZ[i], dirX[i]);
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    run("asin_std", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += std::asin(dirY[i]);
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    run("asin_fast", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += RTFastAsin(dirY[i]);
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    run("pow32_std", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += std::pow(powBase[i], 32.0f);
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    run("pow32_fast", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += RTFastPow(powBase[i], 32.0f);
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    run("sqrt_std", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += std::sqrt(powBase[i]);
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    run("sqrt_fast", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += RTFastSqrt(powBase[i]);
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    run("pow32_int", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += RTFastPowInt(powBase[i], 32);
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+#ifdef RT_FAST_MATH_SSE
+    run("pow32_fast_sse", [&]() {
+        __m128 sum = _mm_setzero_ps();
+        const __m128 exponent = _mm_set1_ps(32.0f);
+        for (size_t i = 0; i + 4 <= n; i += 4) sum = _mm_add_ps(sum, RTFastPowSSE(_mm_loadu_ps(&powBase[i]), exponent));
+        gSink = _mm_cvtss_f32(sum);
+        return static_cast<double>(n / 4 * 4);
+    });
+#endif
+
+    run("direction_to_uv_fast", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            float u, v;
+            RTDirectionToUV(normals[i], u, v, MATH_PRECISION_FAST);
+            sum += u + v;
+        }
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    // RTSimdKernels::directionToUV：SoA 方向批量换算（ENGINE_WAVEFRONT 的环境贴图阶段）
+    for (RTSimdLevel level : levels) {
+        RTSimdKernels kernels = RTGetSimdKernels(level);
+        if (kernels.level != level) continue;
+        run(std::string("direction_to_uv_batch_") + RTSimdLevelName(level), [&, kernels]() {
+            kernels.directionToUV(dirX.data(), dirY.data(), dirZ.data(), static_cast<int>(n), batchU.data(), batchV.data());
+            gSink = batchU[n / 2] + batchV[n / 3];
+            return static_cast<double>(n);
+        });
+    }
+
+    // 立方体贴图的方向换算：选主轴 + 一次除法，批量版本逐位一致
+    std::vector<int> batchFace(n);
+    run("direction_to_cube", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            float s, t;
+            int face = RTDirectionToCube(dirX[i], dirY[i], dirZ[i], s, t);
+            sum += s + t + face;
+        }
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+    for (RTSimdLevel level : levels) {
+        RTSimdKernels kernels = RTGetSimdKernels(level);
+        if (kernels.level != level) continue;
+        run(std::string("direction_to_cube_batch_") + RTSimdLevelName(level), [&, kernels]() {
+            kernels.directionToCube(dirX.data(), dirY.data(), dirZ.data(), static_cast<int>(n),
+                                    batchFace.data(), batchU.data(), batchV.data());
+            gSink = batchU[n / 2] + batchV[n / 3] + batchFace[n / 4];
+            return static_cast<double>(n);
+        });
+    }
+
+    run("sample_texture_random", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += RTSampleTexture(texture, randomU[i], randomV[i]).x;
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    run("sample_texture_coherent", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += RTSampleTexture(texture, coherentU[i], coherentV[i]).x;
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    run("sample_bilinear_random", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += RTSampleBilinear(textureMip.levels[0], randomU[i], randomV[i]).x;
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    run("sample_bilinear_coherent", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += RTSampleBilinear(textureMip.levels[0], coherentU[i], coherentV[i]).x;
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    // 随机 mip 级别（0..4）的三线性采样
+    run("sample_trilinear_random", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += RTSampleMip(textureMip, randomU[i], randomV[i], lods[i]).x;
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    // 纹理存储布局：同一张地球 / 银河纹理分别按行优先与 8x8 分块存储，比较双线性与三线性采样
+    // 缺少纹理文件时用同尺寸量级的程序化纹理代替（名称带 _procedural）
+    struct LayoutTexture {
+        std::string name;
+        RTTexture texture;
+    };
+    std::vector<LayoutTexture> layoutTextures;
+    const struct { const char* name; const char* file; int width, height; uint32_t seed; } layoutSources[] = {
+        {"earth", "earth.png", 1024, 512, 13u},
+        {"milky_way", "milky_way.png", 4096, 2048, 17u},
+    };
+    for (const auto& source : layoutSources) {
+        RTTexture tex = LoadTexture(o.materialDir + "/" + source.file);
+        if (tex.width > 0) {
+            layoutTextures.push_back({source.name, std::move(tex)});
+        } else {
+            layoutTextures.push_back({std::string(source.name) + "_procedural",
+                                      MakeNoiseTexture(source.width, source.height, source.seed)});
+        }
+    }
+    int scanSide = std::max(8, static_cast<int>(std::sqrt(static_cast<double>(n))));
+    std::vector<float> sphereU, sphereV;
+    SphereScanUV(scanSide, sphereU, sphereV);
+    std::vector<float> randomDirU(n), randomDirV(n);
+    for (size_t i = 0; i < n; ++i) RTDirectionToUV(normals[i], randomDirU[i], randomDirV[i]);
+    const RTTextureLayout layouts[] = {TEXTURE_LAYOUT_LINEAR, TEXTURE_LAYOUT_TILED};
+    for (const LayoutTexture& source : layoutTextures) {
+        for (RTTextureLayout layout : layouts) {
+            RTMipTexture mip;
+            mip.Build(source.texture, layout);
+            std::string prefix = "layout_" + source.name + (layout == TEXTURE_LAYOUT_TILED ? "_tiled" : "_linear");
+            run(prefix + "_bilinear_sphere", [&]() {
+                float sum = 0.0f;
+                for (size_t i = 0; i < sphereU.size(); ++i) sum += RTSampleBilinear(mip.levels[0], sphereU[i], sphereV[i]).x;
+                gSink = sum;
+                return static_cast<double>(sphereU.size());
+            });
+            run(prefix + "_bilinear_random", [&]() {
+                float sum = 0.0f;
+                for (size_t i = 0; i < n; ++i) sum += RTSampleBilinear(mip.levels[0], randomDirU[i], randomDirV[i]).x;
+                gSink = sum;
+                return static_cast<double>(n);
+            });
+            run(prefix + "_trilinear_sphere", [&]() {
+                float sum = 0.0f;
+                for (size_t i = 0; i < sphereU.size(); ++i) sum += RTSampleMip(mip, sphereU[i], sphereV[i], 0.5f).x;
+                gSink = sum;
+                return static_cast<double>(sphereU.size());
+            });
+        }
+    }
+
+    run("sample_environment", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += RTSampleEnvironment(environment, 1.5f, dirs[i]).y;
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    // 同一环境贴图在加载时转换为立方体贴图（面边长 512），未击中光线的换算与双线性采样
+    RTMipTexture environmentMip;
+    environmentMip.Build(environment);
+    RTCubemap environmentCube;
+    environmentCube.BuildFromEquirect(environmentMip, 0);
+    run("sample_environment_cube", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            float s, t;
+            int face = RTDirectionToCube(dirs[i].x, dirs[i].y, dirs[i].z, s, t);
+            sum += (RTSampleCube(environmentCube, face, s, t, 0.0f) * 1.5f).y;
+        }
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    run("shade_phong", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            sum += RTShadePhong(normals[i], views[i], lightDirs[i], albedos[i], glm::vec3(1.0f)).z;
+        }
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    run("shade_phong_fast", [&]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            sum += RTShadePhong(normals[i], views[i], lightDirs[i], albedos[i], glm::vec3(1.0f), MATH_PRECISION_FAST).z;
+        }
+        gSink = sum;
+        return static_cast<double>(n);
+    });
+
+    if (o.jsonPath == "-") {
+        WriteJson(std::cout, o, results);
+    } else {
+        std::ofstream file(o.jsonPath);
+        if (!file) {
+            std::cerr << "Failed to write " << o.jsonPath << std::endl;
+            return 1;
+        }
+        WriteJson(file, o, results);
+        std::cout << "wrote " << o.jsonPath << std::endl;
+    }
+    return 0;
+}